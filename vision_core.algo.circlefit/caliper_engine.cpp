@@ -0,0 +1,249 @@
+#include "caliper_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CALIPER_ENGINE_SSE2
+#endif
+
+
+void CaliperEngine::clear()
+{
+    calipers_.clear();
+    rowIndex_.clear();
+    colIndex_.clear();
+    w00_.clear();
+    w01_.clear();
+    w10_.clear();
+    w11_.clear();
+    kernel_.clear();
+    kernelRadius_ = 0;
+}
+
+void CaliperEngine::prepare(const std::vector<Geometry>& calipers, int width, int height, double sigma)
+{
+    clear();
+    if (width < 2 || height < 2) {
+        return;
+    }
+
+    // 高斯导数核 g'(x) = -x/sigma^2 * g(x)，缩放使斜率为1的线性剖面输出1
+    if (sigma < 0.4) {
+        sigma = 0.4;
+    }
+    kernelRadius_ = static_cast<int>(std::ceil(3.0 * sigma));
+    kernel_.resize(2 * kernelRadius_ + 1);
+    double norm = 0.0;
+    for (int j = -kernelRadius_; j <= kernelRadius_; ++j) {
+        double g = std::exp(-0.5 * j * j / (sigma * sigma));
+        double d = -j / (sigma * sigma) * g;
+        kernel_[j + kernelRadius_] = static_cast<float>(d);
+        norm += -j * d;
+    }
+    for (auto& k : kernel_) {
+        k = static_cast<float>(k / norm);
+    }
+
+    size_t totalSamples = 0;
+    for (const auto& c : calipers) {
+        int len = static_cast<int>(std::floor(2.0 * c.length1)) + 1;
+        int widthSamples = 2 * static_cast<int>(std::floor(c.length2)) + 1;
+        int blocks = (len + kBlock - 1) / kBlock;
+        totalSamples += static_cast<size_t>(blocks) * kBlock * widthSamples;
+    }
+    rowIndex_.reserve(totalSamples);
+    colIndex_.reserve(totalSamples);
+    w00_.reserve(totalSamples);
+    w01_.reserve(totalSamples);
+    w10_.reserve(totalSamples);
+    w11_.reserve(totalSamples);
+    calipers_.reserve(calipers.size());
+
+    for (const auto& c : calipers) {
+        CaliperTable table;
+        table.sampleBegin = rowIndex_.size();
+        table.profileLength = static_cast<int>(std::floor(2.0 * c.length1)) + 1;
+        int halfWidth = static_cast<int>(std::floor(c.length2));
+        table.widthSamples = 2 * halfWidth + 1;
+        // 主轴方向（图像行向下，phi逆时针为正）
+        table.dirRow = -std::sin(c.phi);
+        table.dirCol = std::cos(c.phi);
+        table.startRow = c.row - c.length1 * table.dirRow;
+        table.startCol = c.col - c.length1 * table.dirCol;
+        // 垂直方向
+        double perpRow = table.dirCol;
+        double perpCol = -table.dirRow;
+        float invWidth = 1.0f / table.widthSamples;
+
+        for (int k0 = 0; k0 < table.profileLength; k0 += kBlock) {
+            for (int m = -halfWidth; m <= halfWidth; ++m) {
+                for (int t = 0; t < kBlock; ++t) {
+                    const int k = k0 + t;
+                    if (k >= table.profileLength) {
+                        // 补齐采样：读取(0, 0)处像素，权重为0
+                        rowIndex_.push_back(0);
+                        colIndex_.push_back(0);
+                        w00_.push_back(0.0f);
+                        w01_.push_back(0.0f);
+                        w10_.push_back(0.0f);
+                        w11_.push_back(0.0f);
+                        continue;
+                    }
+                    double r = table.startRow + k * table.dirRow + m * perpRow;
+                    double cc = table.startCol + k * table.dirCol + m * perpCol;
+                    // 越界采样截断到图像边缘
+                    r = std::min(std::max(r, 0.0), height - 1.0001);
+                    cc = std::min(std::max(cc, 0.0), width - 1.0001);
+                    int r0 = static_cast<int>(r);
+                    int c0 = static_cast<int>(cc);
+                    float fr = static_cast<float>(r - r0);
+                    float fc = static_cast<float>(cc - c0);
+                    rowIndex_.push_back(r0);
+                    colIndex_.push_back(c0);
+                    w00_.push_back((1.0f - fr) * (1.0f - fc) * invWidth);
+                    w01_.push_back((1.0f - fr) * fc * invWidth);
+                    w10_.push_back(fr * (1.0f - fc) * invWidth);
+                    w11_.push_back(fr * fc * invWidth);
+                }
+            }
+        }
+        calipers_.push_back(table);
+    }
+}
+
+void CaliperEngine::measureCaliper(size_t index, const uint8_t* image, int stride, const EdgeOptions& options,
+    std::vector<EdgePoint>* edges, std::vector<float>* profile) const
+{
+    edges->clear();
+    if (index >= calipers_.size() || image == nullptr) {
+        return;
+    }
+    const CaliperTable& table = calipers_[index];
+    const int len = table.profileLength;
+    const int widthSamples = table.widthSamples;
+
+    // step1: 剖面采样，宽度方向加权求和（权重已包含平均系数）
+    // 剖面按块长补齐，补齐部分的权重为0
+    const int blocks = (len + kBlock - 1) / kBlock;
+    const int paddedLen = blocks * kBlock;
+    profile->assign(static_cast<size_t>(paddedLen) + len, 0.0f);
+    float* prof = profile->data();
+    float* deriv = prof + paddedLen;
+    const int32_t* ri = rowIndex_.data() + table.sampleBegin;
+    const int32_t* ci = colIndex_.data() + table.sampleBegin;
+    const float* a = w00_.data() + table.sampleBegin;
+    const float* b = w01_.data() + table.sampleBegin;
+    const float* c = w10_.data() + table.sampleBegin;
+    const float* d = w11_.data() + table.sampleBegin;
+    for (int block = 0; block < blocks; ++block) {
+        const int base = block * widthSamples * kBlock;
+#ifdef CALIPER_ENGINE_SSE2
+        // 4个通道对应4个相邻剖面位置：每个采样的上下两行像素对各用一次16位读取，权重连续加载
+        const __m128i lowByte = _mm_set1_epi32(0xFF);
+        __m128 acc = _mm_setzero_ps();
+        for (int m = 0; m < widthSamples; ++m) {
+            const int s = base + m * kBlock;
+            uint16_t top[kBlock], bottom[kBlock];
+            for (int t = 0; t < kBlock; ++t) {
+                const uint8_t* q = image + static_cast<size_t>(ri[s + t]) * stride + ci[s + t];
+                std::memcpy(&top[t], q, sizeof(uint16_t));
+                std::memcpy(&bottom[t], q + stride, sizeof(uint16_t));
+            }
+            __m128i pt = _mm_setr_epi32(top[0], top[1], top[2], top[3]);
+            __m128i pb = _mm_setr_epi32(bottom[0], bottom[1], bottom[2], bottom[3]);
+            // 小端序：低字节为左像素，高字节为右像素
+            __m128 v00 = _mm_cvtepi32_ps(_mm_and_si128(pt, lowByte));
+            __m128 v01 = _mm_cvtepi32_ps(_mm_srli_epi32(pt, 8));
+            __m128 v10 = _mm_cvtepi32_ps(_mm_and_si128(pb, lowByte));
+            __m128 v11 = _mm_cvtepi32_ps(_mm_srli_epi32(pb, 8));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + s), v00));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(b + s), v01));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(c + s), v10));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(d + s), v11));
+        }
+        _mm_storeu_ps(prof + block * kBlock, acc);
+#else
+        float* out = prof + block * kBlock;
+        for (int m = 0; m < widthSamples; ++m) {
+            for (int t = 0; t < kBlock; ++t) {
+                const int s = base + m * kBlock + t;
+                const uint8_t* p0 = image + static_cast<size_t>(ri[s]) * stride + ci[s];
+                const uint8_t* p1 = p0 + stride;
+                out[t] += a[s] * p0[0] + b[s] * p0[1] + c[s] * p1[0] + d[s] * p1[1];
+            }
+        }
+#endif
+    }
+
+    // step2: 高斯导数滤波，两端不足核宽的位置不参与边缘判断
+    const int rad = kernelRadius_;
+    if (len < 2 * rad + 3) {
+        return;
+    }
+    int k = rad;
+#ifdef CALIPER_ENGINE_SSE2
+    // 4个相邻输出一组，核系数广播，剖面按偏移非对齐读取
+    for (; k + kBlock <= len - rad; k += kBlock) {
+        __m128 acc = _mm_setzero_ps();
+        for (int j = -rad; j <= rad; ++j) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel_[j + rad]), _mm_loadu_ps(prof + k - j)));
+        }
+        _mm_storeu_ps(deriv + k, acc);
+    }
+#endif
+    for (; k < len - rad; ++k) {
+        float sum = 0.0f;
+        for (int j = -rad; j <= rad; ++j) {
+            sum += kernel_[j + rad] * prof[k - j];
+        }
+        deriv[k] = sum;
+    }
+
+    // step3: 局部极值 + 阈值 + 极性筛选，抛物线插值亚像素位置
+    const float threshold = static_cast<float>(options.threshold);
+    for (k = rad + 1; k < len - rad - 1; ++k) {
+        float v = deriv[k];
+        float absV = std::fabs(v);
+        if (absV < threshold) {
+            continue;
+        }
+        if (options.transition == Positive && v <= 0) {
+            continue;
+        }
+        if (options.transition == Negative && v >= 0) {
+            continue;
+        }
+        float prev = std::fabs(deriv[k - 1]);
+        float next = std::fabs(deriv[k + 1]);
+        if (absV < prev || absV <= next) {
+            continue;
+        }
+        // 相邻点符号不同则不参与插值
+        double offset = 0.0;
+        float l = deriv[k - 1], r = deriv[k + 1];
+        if ((l > 0) == (v > 0) && (r > 0) == (v > 0)) {
+            double denom = l - 2.0 * v + r;
+            if (std::fabs(denom) > 1e-12) {
+                offset = 0.5 * (l - r) / denom;
+                offset = std::min(std::max(offset, -0.5), 0.5);
+            }
+        }
+        double t = k + offset;
+        EdgePoint pt;
+        pt.row = table.startRow + t * table.dirRow;
+        pt.col = table.startCol + t * table.dirCol;
+        pt.amplitude = v;
+        edges->push_back(pt);
+    }
+
+    if (edges->size() > 1) {
+        if (options.select == First) {
+            edges->resize(1);
+        }
+        else if (options.select == Last) {
+            EdgePoint last = edges->back();
+            edges->assign(1, last);
+        }
+    }
+}
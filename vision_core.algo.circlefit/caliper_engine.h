@@ -0,0 +1,86 @@
+#ifndef CALIPER_ENGINE_H
+#define CALIPER_ENGINE_H
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/*
+    原生卡尺边缘测量引擎 ---- 不依赖Halcon，语义与MeasurePos保持一致
+    1. 沿卡尺主轴按整像素步长采样，每个采样点在垂直方向(±L2)取双线性插值后求平均
+    2. 对剖面做高斯导数滤波(sigma)，幅值绝对值超过阈值的局部极值作为边缘
+    3. 按极性(transition)和选择模式(select)输出，边缘位置用抛物线插值到亚像素
+    采样表(像素索引 + 双线性权重)在prepare时一次生成，测量时只做加权求和
+    剖面加权求和与导数卷积在SSE2可用时按4个剖面点并行计算，否则走标量路径
+*/
+class CaliperEngine
+{
+public:
+    enum Transition { Positive, Negative, All };
+    enum Select { First, Last, AllPoints };
+
+    // 单个卡尺的几何参数（Halcon约定：row, col, phi为主轴方向弧度，length1/length2为半长/半宽）
+    struct Geometry {
+        double row;
+        double col;
+        double phi;
+        double length1;
+        double length2;
+    };
+
+    // 边缘测量参数
+    struct EdgeOptions {
+        double threshold = 15.0;
+        Transition transition = Positive;
+        Select select = First;
+    };
+
+    // 边缘点
+    struct EdgePoint {
+        double row;
+        double col;
+        double amplitude;
+    };
+
+    CaliperEngine() = default;
+
+    // 生成采样表和高斯导数核，卡尺几何、图像尺寸或sigma变化时调用
+    void prepare(const std::vector<Geometry>& calipers, int width, int height, double sigma);
+    // 清空采样表
+    void clear();
+    bool isPrepared() const { return !calipers_.empty(); }
+    size_t caliperCount() const { return calipers_.size(); }
+
+    // 测量单个卡尺，image为8位单通道图像，stride为行字节数；profile为调用方提供的临时缓存，可跨调用复用
+    void measureCaliper(size_t index, const uint8_t* image, int stride, const EdgeOptions& options,
+        std::vector<EdgePoint>* edges, std::vector<float>* profile) const;
+
+private:
+    // 单个卡尺的采样表在全局数组中的区间，以及剖面起点/方向
+    struct CaliperTable {
+        size_t sampleBegin;
+        int profileLength;
+        int widthSamples;
+        double startRow;
+        double startCol;
+        double dirRow;
+        double dirCol;
+    };
+
+    std::vector<CaliperTable> calipers_;
+    // 采样表（SoA布局）：左上像素的行内偏移和4个双线性权重(已乘以1/宽度采样数)
+    // 剖面按4个相邻采样位置分块，块内按(宽度采样, 位置)交错存放，SIMD每个通道累加一个剖面值
+    // 末块不足4个位置时以权重为0的采样补齐
+    static const int kBlock = 4;
+    std::vector<int32_t> rowIndex_;
+    std::vector<int32_t> colIndex_;
+    std::vector<float> w00_;
+    std::vector<float> w01_;
+    std::vector<float> w10_;
+    std::vector<float> w11_;
+    // 高斯导数核（归一化为单位斜率输出1）
+    std::vector<float> kernel_;
+    int kernelRadius_ = 0;
+};
+
+#endif // CALIPER_ENGINE_H
@@ -12,18 +12,48 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <functional>
 #include "drawing_result_manager.h"
 #include "result_shape.h"
+#include "result_batch.h"
 #include "algorithm_input.h"
 #include "logger_utils.h"
 using namespace std::chrono;
 
+namespace {
+    // 有界并行：min(threads, count)个工作线程按原子下标领取任务（卡尺/圆环），fn(任务下标, 工作线程编号)
+    // 每个任务只由一个线程处理，其测量句柄/结果槽位不会被共享
+    void parallelFor(size_t count, int threads, const std::function<void(size_t, int)>& fn)
+    {
+        int workers = static_cast<int>(std::min<size_t>(threads > 0 ? threads : 1, count));
+        if (workers <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i, 0);
+            }
+            return;
+        }
+        std::atomic<size_t> nextIndex(0);
+        std::vector<std::future<void>> futures;
+        futures.reserve(workers);
+        for (int w = 0; w < workers; ++w) {
+            futures.push_back(std::async(std::launch::async, [&, w]() {
+                for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+                    fn(i, w);
+                }
+            }));
+        }
+        for (auto& f : futures) {
+            f.get();
+        }
+    }
+}
+
 
 CircleFitAlgorithm::CircleFitAlgorithm(): 
     prop_obj_(new ConfigurableObject()),
-    center_(Pointf(0.0f, 0.0f)),
-    inner_radius_(0.0f),
-    outer_radius_(0.0f),
     init_param_status_(false)
 {
     setupProperties();
@@ -31,7 +61,7 @@ CircleFitAlgorithm::CircleFitAlgorithm():
 
 CircleFitAlgorithm::~CircleFitAlgorithm()
 {
-
+    releaseRings();
 }
 
 bool CircleFitAlgorithm::initialize()
@@ -64,12 +94,14 @@ void CircleFitAlgorithm::setupProperties()
         .defaultValue("从暗到明")
         .registerTo(prop_obj_);
 
-    PropertyBuilder::create("选择测量方向", "direction")
+    // 原"direction"属性比较的是"由内向外"，从未生效，旧配方实际全部从外向内测量
+    // 改用新键并默认从外向内，旧配方中的"direction"被忽略，测量结果保持不变
+    PropertyBuilder::create("选择测量方向", "measure_direction")
         .category("基本参数")
         .type(QMetaType::QVariantMap)
         .enums({ {"从内向外", 0},
                 {"从外向内", 1} })
-        .defaultValue("从内向外")
+        .defaultValue("从外向内")
         .registerTo(prop_obj_);
 
     // 新增阈值调整函数
@@ -88,6 +120,92 @@ void CircleFitAlgorithm::setupProperties()
         .defaultValue("第一点")
         .registerTo(prop_obj_);
 
+    PropertyBuilder::create("卡尺测量后端", "measure_backend")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("测量线程数(0为自动)", "measure_threads")
+        .category("基本参数")
+        .type(QMetaType::Int)
+        .defaultValue(0)
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("连续跟踪模式", "temporal_mode")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"开启", 1} })
+        .defaultValue("关闭")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("圆环跟随系数(0~1)", "follow_rate")
+        .category("基本参数")
+        .type(QMetaType::Double)
+        .defaultValue(0.3)
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("离群点预筛选", "consensus_prestage")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"开启", 1} })
+        .defaultValue("关闭")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("预筛选内点阈值(像素)", "consensus_threshold")
+        .category("基本参数")
+        .type(QMetaType::Double)
+        .defaultValue(2.0)
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("自适应卡尺密度", "adaptive_density")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"开启", 1} })
+        .defaultValue("关闭")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("初始卡尺数", "coarse_handle_num")
+        .category("基本参数")
+        .type(QMetaType::Int)
+        .defaultValue(12)
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("拟合不确定度目标(像素)", "target_uncertainty")
+        .category("基本参数")
+        .type(QMetaType::Double)
+        .defaultValue(0.05)
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("同心双圆模式", "concentric_mode")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"开启", 1} })
+        .defaultValue("关闭")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("双圆共用圆心", "shared_center")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"开启", 1} })
+        .defaultValue("开启")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("拟合方式", "fit_method")
+        .category("基本参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"IRLS", 0},
+                {"几何LM", 1} })
+        .defaultValue("IRLS")
+        .registerTo(prop_obj_);
+
     PropertyBuilder::create("权重类型", "weight_type")
         .category("基本参数")
         .type(QMetaType::QVariantMap)
@@ -137,24 +255,35 @@ ConfigurableObject* CircleFitAlgorithm::getPropertyObj()
 void CircleFitAlgorithm::setParameters(const QJsonObject& p)
 {
     prop_obj_->setPropetyFromJson(p);
+    releaseRings();
 
-    std::shared_ptr<RoiRing> ring = nullptr;
+    // 支持多个圆环，每个圆环可在ring_tolerances中按顺序单独配置管控参数
+    ringTolerances_.clear();
+    for (auto item : p["ring_tolerances"].toArray()) {
+        QJsonObject tol = item.toObject();
+        RingTolerance tolerance;
+        if (tol.contains("std_cx") && tol.contains("std_cy") && tol.contains("std_radius")) {
+            tolerance.valid = true;
+            tolerance.cx = tol["std_cx"].toDouble();
+            tolerance.cy = tol["std_cy"].toDouble();
+            tolerance.radius = tol["std_radius"].toDouble();
+            tolerance.permissibleErr = tol.contains("permissibleErr") ?
+                tol["permissibleErr"].toDouble() : prop_obj_->propValue("permissibleErr").toDouble();
+        }
+        ringTolerances_.push_back(tolerance);
+    }
     for (auto roi : p["rois"].toArray())
     {
-        auto shape = RoiShape::fromJson(roi.toObject());
-        if (shape->type() == RoiShape::Ring) {
-            ring = std::static_pointer_cast<RoiRing>(shape);
-            break;
+        auto ctx = ringFromShape(RoiShape::fromJson(roi.toObject()));
+        if (!ctx) {
+            continue;
         }
+        rings_.push_back(std::move(ctx));
     }
 
-    if (!ring) {
+    if (rings_.empty()) {
         return;
     }
-
-    center_ = Pointf(ring->center().x(), ring->center().y());
-    inner_radius_ = ring->innerRadius();
-    outer_radius_ = ring->outterRadius();
     init_param_status_ = true;
 }
 
@@ -166,40 +295,7 @@ void CircleFitAlgorithm::setRunParameters(const QMap<QString, QList<QPair<QStrin
 }
 
 // ========================== 私有方法实现 ===================== // 
-    // 1. 鲁棒性的初始估计
-void CircleFitAlgorithm::computeSmallDataInitialEstimate(const std::vector<Pointf>& points, double& center_x, double& center_y, double& radius)
-{
-    const int n = points.size();
-    if (n < 3) {
-        center_x = 0.0;
-        center_y = 0.0;
-        radius = 0.0;
-        return;
-    }
-    // 方法1：使用中位数而不是平均值
-    std::vector<double> x_vals, y_vals;
-    for (const auto& p : points) {
-        x_vals.push_back(p.x);
-        y_vals.push_back(p.y);
-    }
-    std::sort(x_vals.begin(), x_vals.end());
-    std::sort(y_vals.begin(), y_vals.end());
-
-    center_x = x_vals[n / 2];
-    center_y = y_vals[n / 2];
-
-    // 计算基于中位数的半径
-    std::vector<double> distances;
-    for (const auto& p : points) {
-        double dx = p.x - center_x;
-        double dy = p.y - center_y;
-        distances.push_back(std::sqrt(dx * dx + dy * dy));
-    }
-    std::sort(distances.begin(), distances.end());
-    radius = distances[distances.size() / 2];
-}
-
-// 2. 计算几何距离残差 
+// 1. 计算几何距离残差 
 double CircleFitAlgorithm::geometricResidual(double x, double y, double cx, double cy, double r)
 {
     double dx = x - cx;
@@ -208,25 +304,7 @@ double CircleFitAlgorithm::geometricResidual(double x, double y, double cx, doub
     return std::abs(dist - r);
 }
 
-// 3. Huber权重函数，效果不及Tukey
-double CircleFitAlgorithm::HuberWeight(double residual, double k)
-{
-    double abs_r = std::abs(residual);
-    return (abs_r <= k) ? 1.0 : k / abs_r;
-}
-
-// 4. Tukey权重函数
-double CircleFitAlgorithm::TukeyWeight(double residual, double k)
-{
-    double r_over_k = residual / k;
-    if (std::abs(r_over_k) <= 1.0) {
-        double tmp = 1.0 - r_over_k * r_over_k;
-        return tmp * tmp;
-    }
-    return 0.0;
-}
-
-// 5. 圆的一致性验证函数
+// 2. 圆的一致性验证函数
 double CircleFitAlgorithm::validateCircleConsistency(const std::vector<Pointf>& points, double center_x, double center_y, double radius)
 {
     const double m_PI = 3.1415926;
@@ -275,162 +353,16 @@ Circle CircleFitAlgorithm::FitCircle(const std::vector<Pointf>& points, const Fi
 // ==================== 简单的最小二乘拟合算法 ======================== //
 Circle CircleFitAlgorithm::fitCircleSimpleLS(const std::vector<Pointf>& points)
 {
-    // 简单的线性最小二乘圆拟合
-    const int n = points.size();
-    if (n < 3) {
-        return Circle(0, 0, 0);
-    }
-    Eigen::MatrixXd A(n, 3);
-    Eigen::VectorXd b(n);
-    // 简单的最小二乘拟合求解
-    for (int i = 0; i < n; i++) {
-        double x = points[i].x;
-        double y = points[i].y;
-        A(i, 0) = x;
-        A(i, 1) = y;
-        A(i, 2) = 1.0;
-        b(i) = x * x + y * y;
-    }
-    // 矩阵求解
-    Eigen::Vector3d params = A.colPivHouseholderQr().solve(b);
-    double center_x = params(0) / 2.0;
-    double center_y = params(1) / 2.0;
-    double radius_sq = params(2) + center_x * center_x + center_y * center_y;
-    double radius = (radius_sq > 0) ? std::sqrt(radius_sq) : 0.0;
-    Circle result(center_x, center_y, radius);
-    result.error = CalculateRMSE(points, center_x, center_y, radius);
-    result.method = "SimpleLS";
-    result.IsConverged = true;
-    return result;
+    // 实现放在不依赖Halcon/Qt的求解器中，基准测试程序与插件使用同一份代码
+    return IrlsCircleSolver::fitSimpleLS(points);
 }
 
 // ======================= 圆拟合核心算法实现 ===================== //
 Circle CircleFitAlgorithm::fitCircleIRLSOptimized(const std::vector<Pointf>& points, const FitConfig& config)
 {
-    auto start = system_clock::now();
-    // 计算圆拟合点的数量
-    const int n = points.size();
-    // 选择权重函数
-    auto weight_func = (prop_obj_->propValue("weight_type") == "tukey") ? TukeyWeight : HuberWeight;
-    // 预计算点坐标和平方和
-    Eigen::VectorXd x_vec(n), y_vec(n), z_vec(n);
-    double center_x = 0.0, center_y = 0.0, radius = 0.0;
-    for (int i = 0; i < n; i++) {
-        x_vec(i) = points[i].x;
-        y_vec(i) = points[i].y;
-        z_vec(i) = points[i].x * points[i].x + points[i].y * points[i].y;
-    }
-    // 初始圆心估计（使用所有点的平均值）
-    center_x = x_vec.mean();
-    center_y = y_vec.mean();
-    // 初始半径估计
-    computeSmallDataInitialEstimate(points, center_x, center_y, radius);
-    // 初始化权重全部设为1
-    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
-    // 预分配内存
-    Eigen::MatrixXd A(n, 3);
-    Eigen::VectorXd b(n);
-    Eigen::VectorXd residuals(n);
-    // IRLS迭代
-    int iter = 0;
-    double adaptive_kFactor = config.k_factor;  // prop_obj_->propValue("factor").toDouble();
-    bool converged = false;
-    double prev_err = (std::numeric_limits<double>::max());
-    int maxIterations = config.max_iterations;  // prop_obj_->propValue("iterations").toInt();
-    for (iter = 0; iter < maxIterations; ++iter) {
-        // 计算当前残差（几何距离）---- 所有候选点进行迭代
-        for (int i = 0; i < n; ++i) {
-            double dx = x_vec(i) - center_x;
-            double dy = y_vec(i) - center_y;
-            residuals(i) = std::abs(std::sqrt(dx * dx + dy * dy) - radius);
-        }
-        // 迭代一轮之后计算当前误差
-        double cur_err = residuals.norm() / std::sqrt(n);
-        // 误差计算完成后，计算是否收敛，可提前结束迭代
-        if (std::abs(prev_err - cur_err) <= config.tolerance || cur_err < config.tolerance) {
-            converged = true;
-            break;
-        }
-        // 不满足要求，则更新当前的误差
-        prev_err = cur_err;
-        // 计算残差的中位数绝对偏差（MAD）来估计尺度参数
-        Eigen::VectorXd sorted_residuals = residuals;
-        std::sort(sorted_residuals.data(), sorted_residuals.data() + n);
-        double q1 = sorted_residuals(n / 4);
-        double q3 = sorted_residuals(3 * n / 4);
-        double iqr = q3 - q1;
-        // 自适应调整k_factor,在初期更容忍离群点
-        if (iter < 3) {
-            adaptive_kFactor = 3.0 * config.k_factor;		// 初期宽松
-        }
-        else if (iter < 8) {
-            adaptive_kFactor = 2.0 * config.k_factor;		// 中期适中
-        }
-        else {
-            adaptive_kFactor = config.k_factor;				// 后期严格
-        }
-        // 估计偏差值
-        double sigma = (iqr > 1e-6) ? iqr / 1.349 : 1.0;
-        double k = adaptive_kFactor * sigma;
-        // 更新权重 ----- 优化小数据集的适配性
-        for (int i = 0; i < n; ++i) {
-            // weights(i) = weight_func(residuals(i), k);
-            // 小数据集避免完全排除任何点
-            if (n < 15 && residuals(i) > 4.0 * k) {
-                weights(i) = 0.1;		// 保留最小权重而不是完全排除
-            }
-            else {
-                weights(i) = weight_func(residuals(i), k);
-            }
-        }
-        // 构建加权最小二乘问题
-        for (int i = 0; i < n; ++i) {
-            // 防止权重为0导致数值问题
-            double w = std::sqrt(std::max(weights(i), 1e-12));
-            A(i, 0) = w * x_vec(i);
-            A(i, 1) = w * y_vec(i);
-            A(i, 2) = w;
-            b(i) = w * z_vec(i);
-        }
-        // 使用QR分解求解加权最小二乘问题
-        Eigen::Vector3d params;
-        try {
-            Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(A);
-            if (qr.rank() < 3) {
-                // 秩不足，使用SVD
-                params = A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
-            }
-            else {
-                params = qr.solve(b);
-            }
-        }
-        catch (const std::exception& e) {
-            params = A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
-        }
-        // 从分解的参数中获取圆心和半径
-        double new_center_x = params(0) / 2.0;
-        double new_center_y = params(1) / 2.0;
-        double new_radius_sq = (params(2) + new_center_x * new_center_x + new_center_y * new_center_y);
-        // 确保半径平方为正数
-        double new_radius = std::sqrt(new_radius_sq);
-        // 检查新解是否合理
-        if (new_radius > 1e-6 && std::isfinite(new_radius)) {
-            // 优化10：添加阻尼更新，避免剧烈变化
-            double damping = 0.15;		// 阻尼因子
-            center_x = damping * center_x + (1 - damping) * new_center_x;
-            center_y = damping * center_y + (1 - damping) * new_center_y;
-            radius = damping * radius + (1 - damping) * new_radius;
-        }
-    }
-    Circle result(center_x, center_y, radius);
-    // 单次迭代完成之后，进行计算最终拟合误差
-    /*result.error = CalculateRMSE(points, center_x, center_y, radius);
-    result.iterations = iter;
-    result.method = "IRLS_(" + config.weight_type + ")";
-    result.IsConverged = converged;
-    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(system_clock::now() - start).count();
-    std::cout << "标准算法所耗费时间为:" << diff << "ms" << std::endl;*/
-    return result;
+    // 权重类型每次拟合只解析一次，迭代内部使用编译期特化的权重函数
+    auto weight = IrlsCircleSolver::weightTypeFromString(prop_obj_->propValue("weight_type").toString().toStdString());
+    return solver_.fit(points, config, weight);
 }
 
 // 6. =============== 再优化一般小的圆拟合算法实现 ======================//
@@ -438,122 +370,11 @@ Circle CircleFitAlgorithm::fitCircleIRLSOptimized_plus(const std::vector<Pointf>
 {
     // 拟合之前默认结果是正确的
     IsOK = true;
-    auto start = system_clock::now();
-    // 计算圆拟合点的数量
-    const int n = points.size();
-    // 选择权重函数
-    auto weight_func = (prop_obj_->propValue("weight_type") == "tukey") ? TukeyWeight : HuberWeight;
-
-    // 预计算点坐标和平方和
-    Eigen::VectorXd x_vec(n), y_vec(n), z_vec(n);
-    double center_x = 0.0, center_y = 0.0, radius = 0.0;
-    for (int i = 0; i < n; i++) {
-        x_vec(i) = points[i].x;
-        y_vec(i) = points[i].y;
-        z_vec(i) = points[i].x * points[i].x + points[i].y * points[i].y;
-    }
-    // 初始圆心估计（使用所有点的平均值）
-    center_x = x_vec.mean();
-    center_y = y_vec.mean();
-    // 初始半径估计
-    computeSmallDataInitialEstimate(points, center_x, center_y, radius);
-    // 初始化权重全部设为1
-    Eigen::VectorXd weights = Eigen::VectorXd::Ones(n);
-    // 预分配内存
-    Eigen::MatrixXd A(n, 3);
-    Eigen::VectorXd b(n);
-    Eigen::VectorXd residuals(n);
-    // IRLS迭代
-    int iter = 0;
-    double adaptive_kFactor = config.k_factor;  //prop_obj_->propValue("factor").toDouble();
-    bool converged = false;
-    double prev_err = std::numeric_limits<double>::max();
-    int maxIterations = config.max_iterations;  // prop_obj_->propValue("iterations").toInt();
-    for (iter = 0; iter < maxIterations; ++iter) {
-        // 计算当前残差（几何距离）---- 所有候选点进行迭代
-        for (int i = 0; i < n; ++i) {
-            double dx = x_vec(i) - center_x;
-            double dy = y_vec(i) - center_y;
-            residuals(i) = std::abs(std::sqrt(dx * dx + dy * dy) - radius);
-        }
-        // 迭代一轮之后计算当前误差
-        double cur_err = residuals.norm() / std::sqrt(n);
-        // 误差计算完成后，计算是否收敛，可提前结束迭代
-        if (std::abs(prev_err - cur_err) <= config.tolerance || cur_err < config.tolerance) {
-            converged = true;
-            break;
-        }
-        // 不满足要求，则更新当前的误差
-        prev_err = cur_err;
-        // 计算残差的中位数绝对偏差（MAD）来估计尺度参数
-        Eigen::VectorXd sorted_residuals = residuals;
-        std::sort(sorted_residuals.data(), sorted_residuals.data() + n);
-        double q1 = sorted_residuals(n / 4);
-        double q3 = sorted_residuals(3 * n / 4);
-        double iqr = q3 - q1;
-        // 自适应调整k_factor,在初期更容忍离群点
-        if (iter < 3) {
-            adaptive_kFactor = 3.0 * config.k_factor; // prop_obj_->propValue("factor").toDouble();		// 初期宽松 3， 3.0
-        }
-        else if (iter < 8) {
-            adaptive_kFactor = 2.0 * config.k_factor; // prop_obj_->propValue("factor").toDouble();		// 中期适中 8， 2.0
-        }
-        else {
-            adaptive_kFactor = config.k_factor;       // prop_obj_->propValue("factor").toDouble();	    // 后期严格
-        }
-        // 估计偏差值
-        double sigma = (iqr > 1e-6) ? iqr / 1.349 : 1.0;
-        double k = adaptive_kFactor * sigma;
-        // 更新权重----适应小数据集
-        for (int i = 0; i < n; ++i) {
-            // 小数据集避免完全排除任何点
-            if (n < 15 && residuals(i) > 4.0 * k) {
-                weights(i) = 0.1;		// 保留最小权重而不是完全排除
-            }
-            else {
-                weights(i) = weight_func(residuals(i), k);
-            }
-        }
-        // 构建加权最小二乘问题
-        for (int i = 0; i < n; ++i) {
-            // 防止权重为0导致数值问题
-            double w = std::sqrt(std::max(weights(i), 1e-12));
-            A(i, 0) = w * x_vec(i);
-            A(i, 1) = w * y_vec(i);
-            A(i, 2) = w;
-            b(i) = w * z_vec(i);
-        }
-        // 使用QR分解求解加权最小二乘问题
-        Eigen::Vector3d params;
-        try {
-            Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(A);
-            if (qr.rank() < 3) {
-                // 秩不足，使用SVD
-                params = A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
-            }
-            else {
-                params = qr.solve(b);
-            }
-        }
-        catch (const std::exception& e) {
-            params = A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
-        }
-        // 从分解的参数中获取圆心和半径
-        double new_center_x = params(0) / 2.0;
-        double new_center_y = params(1) / 2.0;
-        double new_radius_sq = (params(2) + new_center_x * new_center_x + new_center_y * new_center_y);
-        // 确保半径平方为正数
-        double new_radius = std::sqrt(new_radius_sq);
-        // 检查新解是否合理
-        if (new_radius > 1e-6 && std::isfinite(new_radius)) {
-            // 优化10：添加阻尼更新，避免剧烈变化
-            double damping = 0.15;		// 阻尼因子
-            center_x = damping * center_x + (1 - damping) * new_center_x;
-            center_y = damping * center_y + (1 - damping) * new_center_y;
-            radius = damping * radius + (1 - damping) * new_radius;
-        }
-    }
-    Circle result(center_x, center_y, radius);
+    auto weight = IrlsCircleSolver::weightTypeFromString(prop_obj_->propValue("weight_type").toString().toStdString());
+    Circle result = solver_.fit(points, config, weight);
+    double center_x = result.center_x;
+    double center_y = result.center_y;
+    double radius = result.radius;
     // 新增判断圆拟合结果是否正常
     float cxErr = 0, cyErr = 0, radiusErr = 0, permissibleErr = 0;
     cxErr = fabs(center_x - prop_obj_->propValue("std_cx").toInt());
@@ -563,16 +384,28 @@ Circle CircleFitAlgorithm::fitCircleIRLSOptimized_plus(const std::vector<Pointf>
     if (cxErr > permissibleErr || cyErr > permissibleErr || radiusErr > permissibleErr) {
         IsOK = false;
     }
-    // 单次迭代完成之后，进行计算最终拟合误差
-    /*result.error = CalculateRMSE(points, center_x, center_y, radius);
-    result.iterations = iter;
-    result.method = "IRLS_(" + prop_obj_->propValue("weight_type").toString().toStdString() + ")";
-    result.IsConverged = converged;
-    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(system_clock::now() - start).count();
-    std::cout << "标准算法所耗费时间为:" << diff << "ms" << std::endl;*/
     return result;
 }
 
+std::vector<Circle> CircleFitAlgorithm::fitCircleBatch(const std::vector<int>& offsets, const std::vector<double>& xs,
+    const std::vector<double>& ys, int threads)
+{
+    std::vector<Circle> circles;
+    if (offsets.size() < 2 || xs.size() != ys.size() || offsets.back() > static_cast<int>(xs.size())) {
+        zyhn_core::LoggerUtils::error("circlefit", "批量拟合偏移表与坐标数量不一致!");
+        return circles;
+    }
+    const int count = static_cast<int>(offsets.size()) - 1;
+    circles.resize(count);
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    FitConfig config;
+    auto weight = IrlsCircleSolver::weightTypeFromString(prop_obj_->propValue("weight_type").toString().toStdString());
+    IrlsCircleSolver::fitBatch(offsets.data(), count, xs.data(), ys.data(), config, weight, threads, circles.data());
+    return circles;
+}
+
 double CircleFitAlgorithm::CalculateRMSE(const std::vector<Pointf>& points, double center_x, double center_y, double radius)
 {
     double error = 0.0;
@@ -586,123 +419,733 @@ double CircleFitAlgorithm::CalculateRMSE(const std::vector<Pointf>& points, doub
 }
 
 // ======================= 新增卡尺测量模块 =============================== //
-int CircleFitAlgorithm::measureCirclePts(HalconCpp::HObject& hSrc, Pointf& center, const float& innerRadius, const float& outterRadius, std::vector<Pointf>* allPts)
+void CircleFitAlgorithm::readCaliperOptions(CaliperPlan& plan) const
 {
-    allPts->clear();
-    using namespace HalconCpp;
-    HObject nullImg;
-    HTuple hRes, width, height;
-    GenEmptyObj(&nullImg);
-    TestEqualObj(hSrc, nullImg, &hRes);
-    if (hRes == 1) {
-        zyhn_core::LoggerUtils::error("circlefit","输入图像为空!");
-        return -1;
-    }
-    GetImageSize(hSrc, &width, &height);
-    // 输入的圆环中心，内外径大小
-    double cCol = 0.0, cRow = 0.0;
-    cRow = center.y;
-    cCol = center.x;
-    float measureLength = (outterRadius - innerRadius);        
-    if (measureLength < 5) {
-        return -1;                                                    // 测量长度错误
-    }
-    // 确保测量长度不低于5个像素长度 (调试阶段使用断言，发布阶段关闭断言提高程序运行效率)
-    /* 如果condition判断结果为false，则程序就会停止执行；否则继续执行*/
-    float measureRadius = 0.5 * (outterRadius + innerRadius);
-    // 计算测量的角度步长范围
-    int m_handleNum = prop_obj_->propValue("handleNum").toInt();
-    float stepAngle = 360.0 / m_handleNum;		// 36为需要测量的卡尺点数量
-    std::string transition = "";
-    QString transitionProp = prop_obj_->propValue("transition").toString();
+    plan.handleNum = prop_obj_->propValue("handleNum").toInt();
     // step1: 选择测量极性
+    QString transitionProp = prop_obj_->propValue("transition").toString();
     if (transitionProp == "从暗到明") {
-        transition = "positive";
+        plan.transition = "positive";
     }
     else if (transitionProp == "从明到暗") {
-        transition = "negative";
+        plan.transition = "negative";
     }
     else {
-        transition = "all";
+        plan.transition = "all";
     }
     // step2: 选择测量输出点
-    std::string select = "";
     QString selectProp = prop_obj_->propValue("select").toString();
     if (selectProp == "第一点") {
-        select = "first";
+        plan.select = "first";
     }
     else if (selectProp == "最后一点") {
-        select = "last";
+        plan.select = "last";
     }
     else {
-        select = "all";
+        plan.select = "all";
     }
-    // ====================== 遍历测量点 ========================== //
-    QString directionProp = prop_obj_->propValue("direction").toString();
+    // 同心双圆模式需要同一卡尺上两种极性的全部边缘
+    if (prop_obj_->propValue("concentric_mode").toString() == "开启") {
+        plan.transition = "all";
+        plan.select = "all";
+    }
+    plan.sigma = 1.0;
+    plan.threshold = prop_obj_->propValue("threshold").toInt();
+    plan.nativeBackend = prop_obj_->propValue("measure_backend").toString() == "原生";
+    int threads = prop_obj_->propValue("measure_threads").toInt();
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    plan.threads = std::max(1, threads);
+    plan.edgeOptions.threshold = plan.threshold;
+    plan.edgeOptions.transition = plan.transition == "positive" ? CaliperEngine::Positive :
+        (plan.transition == "negative" ? CaliperEngine::Negative : CaliperEngine::All);
+    plan.edgeOptions.select = plan.select == "first" ? CaliperEngine::First :
+        (plan.select == "last" ? CaliperEngine::Last : CaliperEngine::AllPoints);
+    plan.insideOut = prop_obj_->propValue("measure_direction").toString() == "从内向外";
+}
+
+int CircleFitAlgorithm::buildCaliperPlan(CaliperPlan& plan, int width, int height, const Pointf& center, float innerRadius, float outterRadius,
+    double startAngle, double spanAngle)
+{
+    using namespace HalconCpp;
+    releaseCaliperPlan(plan);
+    float measureLength = (outterRadius - innerRadius);
+    if (measureLength < 5) {
+        return -1;                                                    // 测量长度错误
+    }
+    // 确保测量长度不低于5个像素长度
+    float measureRadius = 0.5 * (outterRadius + innerRadius);
+    // 计算测量的角度步长范围
+    readCaliperOptions(plan);
+    int m_handleNum = plan.handleNum;
+    if (m_handleNum <= 0) {
+        return -1;
+    }
+    // 圆弧按与整圆相同的角度密度布置卡尺，被遮挡的扇区不测量
+    const bool fullCircle = spanAngle >= 360.0;
+    if (!fullCircle) {
+        m_handleNum = std::max(3, static_cast<int>(std::lround(m_handleNum * spanAngle / 360.0)));
+    }
+    float stepAngle = fullCircle ? 360.0 / m_handleNum : spanAngle / m_handleNum;
+    const bool insideOut = plan.insideOut;
+
+    // step3: 按角度生成测量句柄，矩形中心 = 圆心 + 测量半径方向偏移（图像行坐标向下，故行偏移取负）
+    double cRow = center.y;
+    double cCol = center.x;
+    float L1 = measureLength / 2.0;
+    float L2 = 5.0;
+    plan.rowOffsets.reserve(m_handleNum);
+    plan.colOffsets.reserve(m_handleNum);
+    plan.handles.reserve(m_handleNum);
     for (int i = 0; i < m_handleNum; ++i) {
         float curAngle = i * stepAngle;
+        if (!fullCircle) {
+            // ROI角度（图像行向下）与Halcon角度符号相反，卡尺位于各等分扇区的中心
+            double halconAngle = std::fmod(-(startAngle + (i + 0.5) * stepAngle), 360.0);
+            curAngle = static_cast<float>(halconAngle < 0 ? halconAngle + 360.0 : halconAngle);
+        }
         if (curAngle < 0 || curAngle >= 360) {
             continue;
         }
-        float R = 0.0, C = 0.0, L1 = 0.0, L2 = 0.0;
-        L1 = measureLength / 2.0;
-        L2 = 5.0;
-        float measurePhi = curAngle * PI / 180.0;
-        // 按照四个象限划分不同的区域,计算测量矩形的中心
-        if (curAngle > 0 && curAngle <= 90) {
-            R = cRow - fabs(measureRadius * sin(measurePhi));
-            C = cCol + fabs(measureRadius * cos(measurePhi));
-        }
-        else if (curAngle > 90 && curAngle <= 180) {
-            R = cRow - fabs(measureRadius * sin(measurePhi));
-            C = cCol - fabs(measureRadius * cos(measurePhi));
-        }
-        else if (curAngle > 180 && curAngle <= 270) {
-            R = cRow + fabs(measureRadius * sin(measurePhi));
-            C = cCol - fabs(measureRadius * cos(measurePhi));
-        }
-        else {
-            R = cRow + fabs(measureRadius * sin(measurePhi));
-            C = cCol + fabs(measureRadius * cos(measurePhi));
-        }
+        double measurePhi = curAngle * PI / 180.0;
+        double dRow = -measureRadius * sin(measurePhi);
+        double dCol = measureRadius * cos(measurePhi);
         // 测量方向改变后需调整角度大小
-        if (directionProp == "由内向外") {
+        if (insideOut) {
             if (measurePhi > PI)
                 measurePhi -= 2 * PI;
         }
         else {
             measurePhi -= PI;
         }
-        // step3: 调用halcon的卡尺测量模块进行卡尺测量
-        float m_sigma = 1.0;
-        int m_threshold = prop_obj_->propValue("threshold").toInt();
-        HTuple rowEdge, colEdge, amplitude, distance, measureHandle;
-        // try {
-        GenMeasureRectangle2(R, C, measurePhi, L1, L2, width, height, "bilinear", &measureHandle);
-        MeasurePos(hSrc, measureHandle, m_sigma, m_threshold, transition.c_str(), select.c_str(),
+        plan.rowOffsets.push_back(dRow);
+        plan.colOffsets.push_back(dCol);
+        if (plan.nativeBackend) {
+            plan.geometries.push_back({ cRow + dRow, cCol + dCol, measurePhi, L1, L2 });
+        }
+        else {
+            HTuple measureHandle;
+            GenMeasureRectangle2(cRow + dRow, cCol + dCol, measurePhi, L1, L2, width, height, "bilinear", &measureHandle);
+            plan.handles.push_back(measureHandle);
+        }
+    }
+    if (plan.nativeBackend) {
+        plan.engine.prepare(plan.geometries, width, height, plan.sigma);
+    }
+    plan.width = width;
+    plan.height = height;
+    plan.centerRow = cRow;
+    plan.centerCol = cCol;
+    plan.innerRadius = innerRadius;
+    plan.outterRadius = outterRadius;
+    plan.startAngle = startAngle;
+    plan.spanAngle = spanAngle;
+    plan.valid = true;
+    return 0;
+}
+
+void CircleFitAlgorithm::releaseCaliperPlan(CaliperPlan& plan)
+{
+    for (auto& handle : plan.handles) {
+        try {
+            HalconCpp::CloseMeasure(handle);
+        }
+        catch (HalconCpp::HException&) {
+        }
+    }
+    plan = CaliperPlan();
+}
+
+std::unique_ptr<CircleFitAlgorithm::RingContext> CircleFitAlgorithm::ringFromShape(const std::shared_ptr<RoiShape>& shape)
+{
+    std::unique_ptr<RingContext> ctx;
+    if (!shape) {
+        return ctx;
+    }
+    if (shape->type() == RoiShape::Ring) {
+        auto ring = std::static_pointer_cast<RoiRing>(shape);
+        ctx.reset(new RingContext());
+        ctx->center = Pointf(ring->center().x(), ring->center().y());
+        ctx->innerRadius = ring->innerRadius();
+        ctx->outerRadius = ring->outterRadius();
+    }
+    else if (shape->type() == RoiShape::ArcRing) {
+        // 圆弧环：零件被夹具遮挡时只在可见圆弧上布置卡尺
+        auto arc = std::static_pointer_cast<RoiArcRing>(shape);
+        ctx.reset(new RingContext());
+        ctx->center = Pointf(arc->center().x(), arc->center().y());
+        ctx->innerRadius = arc->innerRadius();
+        ctx->outerRadius = arc->outterRadius();
+        ctx->spanAngle = std::min(360.0, std::abs(static_cast<double>(arc->spanAngle())));
+        ctx->startAngle = arc->spanAngle() < 0 ? arc->startAngle() + arc->spanAngle() : arc->startAngle();
+    }
+    return ctx;
+}
+
+void CircleFitAlgorithm::releaseRings()
+{
+    for (auto& ring : rings_) {
+        releaseCaliperPlan(ring->plan);
+    }
+    rings_.clear();
+}
+
+int CircleFitAlgorithm::ensureCaliperPlan(CaliperPlan& plan, int width, int height, const Pointf& center, float innerRadius, float outterRadius,
+    double startAngle, double spanAngle)
+{
+    using namespace HalconCpp;
+    // 测量参数、圆环半径、圆弧范围（位姿旋转）或图像尺寸变化时重建测量计划；只有圆心移动（位姿对齐）时平移已有句柄
+    // 属性可能在属性面板中直接修改而不经过setParameters，因此每次都与当前属性比较
+    CaliperPlan options;
+    readCaliperOptions(options);
+    if (!plan.valid || plan.width != width || plan.height != height
+        || plan.innerRadius != innerRadius || plan.outterRadius != outterRadius
+        || plan.startAngle != startAngle || plan.spanAngle != spanAngle
+        || plan.handleNum != options.handleNum || plan.insideOut != options.insideOut
+        || plan.sigma != options.sigma || plan.threshold != options.threshold
+        || plan.transition != options.transition || plan.select != options.select
+        || plan.nativeBackend != options.nativeBackend || plan.threads != options.threads) {
+        return buildCaliperPlan(plan, width, height, center, innerRadius, outterRadius, startAngle, spanAngle);
+    }
+    if (plan.centerRow != center.y || plan.centerCol != center.x) {
+        for (size_t i = 0; i < plan.handles.size(); ++i) {
+            TranslateMeasure(plan.handles[i], center.y + plan.rowOffsets[i], center.x + plan.colOffsets[i]);
+        }
+        for (size_t i = 0; i < plan.geometries.size(); ++i) {
+            plan.geometries[i].row = center.y + plan.rowOffsets[i];
+            plan.geometries[i].col = center.x + plan.colOffsets[i];
+        }
+        if (plan.nativeBackend) {
+            plan.engine.prepare(plan.geometries, plan.width, plan.height, plan.sigma);
+        }
+        plan.centerRow = center.y;
+        plan.centerCol = center.x;
+    }
+    return 0;
+}
+
+int CircleFitAlgorithm::measureCirclePts(HalconCpp::HObject& hSrc, CaliperPlan& plan, std::vector<Pointf>* allPts, int maxThreads)
+{
+    allPts->clear();
+    if (!plan.valid) {
+        return -1;
+    }
+    const int threads = maxThreads > 0 ? std::min(plan.threads, maxThreads) : plan.threads;
+    const size_t count = plan.nativeBackend ? plan.engine.caliperCount() : plan.handles.size();
+    std::vector<size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+    // 结果按卡尺角度顺序写入各自槽位，合并后顺序与串行一致
+    std::vector<std::vector<Pointf>> caliperPts(count);
+    measureCalipers(hSrc, plan, indices, caliperPts, threads);
+    for (const auto& pts : caliperPts) {
+        allPts->insert(allPts->end(), pts.begin(), pts.end());
+    }
+    return 0;
+}
+
+void CircleFitAlgorithm::measureCalipers(HalconCpp::HObject& hSrc, CaliperPlan& plan, const std::vector<size_t>& indices,
+    std::vector<std::vector<Pointf>>& caliperPts, int threads, std::vector<std::vector<double>>* amplitudes)
+{
+    using namespace HalconCpp;
+    if (plan.nativeBackend) {
+        measureCalipersNative(hSrc, plan, indices, caliperPts, threads, amplitudes);
+        return;
+    }
+    // ====================== 遍历测量点 ========================== //
+    const char* transition = plan.transition.c_str();
+    const char* select = plan.select.c_str();
+    parallelFor(indices.size(), threads, [&](size_t k, int) {
+        const size_t idx = indices[k];
+        HTuple rowEdge, colEdge, amplitude, distance;
+        MeasurePos(hSrc, plan.handles[idx], plan.sigma, plan.threshold, transition, select,
             &rowEdge, &colEdge, &amplitude, &distance);
-        CloseMeasure(measureHandle);
-        /*catch (HException& except) {
-            std::cout << "是否存在错误编码:" << except.ErrorCode();
-            return except.ErrorCode();
-        }*/
         // 测量一次则储存一次测量出来的候选拟合点
-        // std::cout << "测量点是否正常:" << rowEdge.Length() << "数值:" << rowEdge.D() << colEdge.D() << std::endl;
-        if (rowEdge.Length() > 0) {
-            // std::cout << "测量点是否正常:" << rowEdge.Length() << "数值:" << rowEdge.D() << colEdge.D() << std::endl;
-            for (int i = 0; i < rowEdge.Length(); i++) {
-                allPts->push_back(Pointf(colEdge[i], rowEdge[i]));
-                // std::cout << "已经正确储存" << std::endl;
+        caliperPts[idx].clear();
+        for (int i = 0; i < rowEdge.Length(); i++) {
+            caliperPts[idx].push_back(Pointf(colEdge[i], rowEdge[i]));
+        }
+        if (amplitudes) {
+            (*amplitudes)[idx].clear();
+            for (int i = 0; i < amplitude.Length(); i++) {
+                (*amplitudes)[idx].push_back(amplitude[i].D());
+            }
+        }
+    });
+}
+
+HalconCpp::HObject CircleFitAlgorithm::toGrayByteImage(const HalconCpp::HObject& hSrc)
+{
+    using namespace HalconCpp;
+    // 原生引擎只处理8位单通道图像，彩色图先转灰度
+    HObject grayImg = hSrc;
+    HTuple channels, type;
+    CountChannels(hSrc, &channels);
+    if (channels.I() == 3) {
+        Rgb1ToGray(hSrc, &grayImg);
+    }
+    GetImageType(grayImg, &type);
+    if (std::string(type.S().Text()) != "byte") {
+        ConvertImageType(grayImg, &grayImg, "byte");
+    }
+    return grayImg;
+}
+
+void CircleFitAlgorithm::measureCalipersNative(HalconCpp::HObject& hSrc, CaliperPlan& plan, const std::vector<size_t>& indices,
+    std::vector<std::vector<Pointf>>& caliperPts, int threads, std::vector<std::vector<double>>* amplitudes)
+{
+    using namespace HalconCpp;
+    HObject grayImg = toGrayByteImage(hSrc);
+    HTuple pointer, type, width, height;
+    GetImagePointer1(grayImg, &pointer, &type, &width, &height);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(pointer.L());
+    const int stride = width.I();
+    const int workers = static_cast<int>(std::min<size_t>(threads, std::max<size_t>(indices.size(), 1)));
+    // 每个工作线程独立的剖面/边缘缓存
+    std::vector<std::vector<CaliperEngine::EdgePoint>> edges(workers);
+    std::vector<std::vector<float>> profiles(workers);
+    parallelFor(indices.size(), workers, [&](size_t k, int w) {
+        const size_t idx = indices[k];
+        plan.engine.measureCaliper(idx, data, stride, plan.edgeOptions, &edges[w], &profiles[w]);
+        caliperPts[idx].clear();
+        for (const auto& edge : edges[w]) {
+            caliperPts[idx].push_back(Pointf(edge.col, edge.row));
+        }
+        if (amplitudes) {
+            (*amplitudes)[idx].clear();
+            for (const auto& edge : edges[w]) {
+                (*amplitudes)[idx].push_back(edge.amplitude);
+            }
+        }
+    });
+}
+
+int CircleFitAlgorithm::measureConcentricPts(HalconCpp::HObject& hSrc, CaliperPlan& plan, const Pointf& center,
+    std::vector<Pointf>* innerPts, std::vector<Pointf>* outerPts, int maxThreads)
+{
+    innerPts->clear();
+    outerPts->clear();
+    if (!plan.valid) {
+        return -1;
+    }
+    const int threads = maxThreads > 0 ? std::min(plan.threads, maxThreads) : plan.threads;
+    const size_t count = plan.nativeBackend ? plan.engine.caliperCount() : plan.handles.size();
+    std::vector<size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+    std::vector<std::vector<Pointf>> caliperPts(count);
+    std::vector<std::vector<double>> amplitudes(count);
+    measureCalipers(hSrc, plan, indices, caliperPts, threads, &amplitudes);
+
+    // step1: 所有边缘按到测量圆心的距离做幅值加权的一维2-means，得到内外边缘的分界半径
+    double minR = std::numeric_limits<double>::max(), maxR = 0.0;
+    for (size_t c = 0; c < count; ++c) {
+        for (const auto& p : caliperPts[c]) {
+            double r = std::hypot(p.x - center.x, p.y - center.y);
+            minR = std::min(minR, r);
+            maxR = std::max(maxR, r);
+        }
+    }
+    if (maxR <= minR) {
+        return 0;
+    }
+    double lo = minR, hi = maxR, split = 0.5 * (lo + hi);
+    for (int iter = 0; iter < 20; ++iter) {
+        double sum[2] = { 0.0, 0.0 }, weight[2] = { 0.0, 0.0 };
+        for (size_t c = 0; c < count; ++c) {
+            for (size_t e = 0; e < caliperPts[c].size(); ++e) {
+                double r = std::hypot(caliperPts[c][e].x - center.x, caliperPts[c][e].y - center.y);
+                double w = std::abs(amplitudes[c][e]);
+                int k = r <= split ? 0 : 1;
+                sum[k] += w * r;
+                weight[k] += w;
             }
         }
+        if (weight[0] <= 0 || weight[1] <= 0) {
+            return 0;
+        }
+        lo = sum[0] / weight[0];
+        hi = sum[1] / weight[1];
+        double next = 0.5 * (lo + hi);
+        if (std::abs(next - split) < 1e-3) {
+            break;
+        }
+        split = next;
+    }
+
+    // step2: 每类的主极性（幅值符号之和），卡尺内取该类同极性幅值最大的边缘
+    double polarity[2] = { 0.0, 0.0 };
+    for (size_t c = 0; c < count; ++c) {
+        for (size_t e = 0; e < caliperPts[c].size(); ++e) {
+            double r = std::hypot(caliperPts[c][e].x - center.x, caliperPts[c][e].y - center.y);
+            polarity[r <= split ? 0 : 1] += amplitudes[c][e];
+        }
+    }
+    for (size_t c = 0; c < count; ++c) {
+        int best[2] = { -1, -1 };
+        double bestAmp[2] = { 0.0, 0.0 };
+        for (size_t e = 0; e < caliperPts[c].size(); ++e) {
+            double r = std::hypot(caliperPts[c][e].x - center.x, caliperPts[c][e].y - center.y);
+            int k = r <= split ? 0 : 1;
+            double amp = amplitudes[c][e];
+            if ((amp > 0) != (polarity[k] > 0)) {
+                continue;
+            }
+            if (std::abs(amp) > bestAmp[k]) {
+                bestAmp[k] = std::abs(amp);
+                best[k] = static_cast<int>(e);
+            }
+        }
+        if (best[0] >= 0) {
+            innerPts->push_back(caliperPts[c][best[0]]);
+        }
+        if (best[1] >= 0) {
+            outerPts->push_back(caliperPts[c][best[1]]);
+        }
     }
     return 0;
 }
 
+int CircleFitAlgorithm::measureCirclePtsAdaptive(HalconCpp::HObject& hSrc, CaliperPlan& plan, IrlsCircleSolver& solver,
+    const FitConfig& config, IrlsCircleSolver::WeightType weight, const AdaptiveDensity& adaptive, std::vector<Pointf>* allPts, int maxThreads)
+{
+    allPts->clear();
+    if (!plan.valid) {
+        return -1;
+    }
+    const int threads = maxThreads > 0 ? std::min(plan.threads, maxThreads) : plan.threads;
+    const size_t count = plan.nativeBackend ? plan.engine.caliperCount() : plan.handles.size();
+    if (count == 0) {
+        return 0;
+    }
+    std::vector<std::vector<Pointf>> caliperPts(count);
+    std::vector<char> measured(count, 0);
+    std::vector<double> caliperResidual(count, 0.0);
+    std::vector<size_t> pending;
+
+    // step1: 均匀的稀疏卡尺；圆弧的卡尺首尾不相邻，两端卡尺都要测量
+    const bool closed = plan.spanAngle >= 360.0;
+    const size_t stride = std::max<size_t>(1, count / std::max(3, adaptive.coarseCount));
+    for (size_t i = 0; i < count; i += stride) {
+        pending.push_back(i);
+    }
+    if (!closed && pending.back() != count - 1) {
+        pending.push_back(count - 1);
+    }
+
+    std::vector<size_t> order;
+    for (int round = 0; !pending.empty(); ++round) {
+        measureCalipers(hSrc, plan, pending, caliperPts, threads);
+        for (size_t idx : pending) {
+            measured[idx] = 1;
+        }
+        pending.clear();
+        allPts->clear();
+        for (const auto& pts : caliperPts) {
+            allPts->insert(allPts->end(), pts.begin(), pts.end());
+        }
+        if (round >= adaptive.maxRounds) {
+            break;
+        }
+
+        // step2: 拟合并估计不确定度，达标即停止
+        double sigma = 0.0;
+        bool fitted = allPts->size() >= 3;
+        if (fitted) {
+            Circle circle = solver.fit(*allPts, config, weight);
+            if (IrlsCircleSolver::estimateUncertainty(*allPts, circle) <= adaptive.targetUncertainty) {
+                break;
+            }
+            // 每个卡尺取其边缘点中最大的几何残差，尺度用中位数估计
+            std::vector<double> residuals;
+            for (size_t idx = 0; idx < count; ++idx) {
+                caliperResidual[idx] = 0.0;
+                for (const auto& p : caliperPts[idx]) {
+                    double r = std::abs(std::hypot(p.x - circle.center_x, p.y - circle.center_y) - circle.radius);
+                    caliperResidual[idx] = std::max(caliperResidual[idx], r);
+                    residuals.push_back(r);
+                }
+            }
+            std::nth_element(residuals.begin(), residuals.begin() + residuals.size() / 2, residuals.end());
+            sigma = 1.4826 * residuals[residuals.size() / 2];
+        }
+
+        // step3: 相邻已测卡尺之间的扇区：任一端无边缘（角度缺口）则在中间加卡尺；
+        // 残差超过3倍尺度的扇区最多加密到最稀疏正常扇区的2倍，避免离群点在点集中占比过高导致鲁棒拟合失效
+        order.clear();
+        for (size_t idx = 0; idx < count; ++idx) {
+            if (measured[idx]) {
+                order.push_back(idx);
+            }
+        }
+        const double residualLimit = std::max(3.0 * sigma, 0.5);
+        std::vector<size_t> uniform;
+        std::vector<std::pair<size_t, size_t>> residualSectors;
+        size_t normalGap = 0;
+        const size_t pairCount = closed ? order.size() : order.size() - 1;
+        for (size_t k = 0; k < pairCount; ++k) {
+            size_t a = order[k];
+            size_t b = order[(k + 1) % order.size()];
+            size_t gap = (b + count - a) % count;
+            if (gap == 0) {
+                gap = count;
+            }
+            if (gap <= 1) {
+                continue;
+            }
+            size_t mid = (a + gap / 2) % count;
+            if (!fitted || caliperPts[a].empty() || caliperPts[b].empty()) {
+                pending.push_back(mid);
+            }
+            else if (caliperResidual[a] > residualLimit || caliperResidual[b] > residualLimit) {
+                residualSectors.push_back({ mid, gap });
+            }
+            else {
+                uniform.push_back(mid);
+                normalGap = std::max(normalGap, gap);
+            }
+        }
+        for (const auto& sector : residualSectors) {
+            if (normalGap == 0 || sector.second >= normalGap) {
+                pending.push_back(sector.first);
+            }
+        }
+        // 没有需要加密的异常扇区但不确定度仍未达标（噪声主导），整体加密一倍
+        if (pending.empty()) {
+            pending.swap(uniform);
+        }
+    }
+    return 0;
+}
+
+// ======================= 多圆环测量 =============================== //
+std::vector<CircleFitAlgorithm::RingMeasurement> CircleFitAlgorithm::measureRings(HalconCpp::HObject& hSrc, const RoiAlignment& alignment)
+{
+    using namespace HalconCpp;
+    std::vector<RingMeasurement> outputs(rings_.size());
+    if (rings_.empty()) {
+        return outputs;
+    }
+    HTuple width, height;
+    GetImageSize(hSrc, &width, &height);
+
+    // 串行阶段：读取属性、对齐圆环中心、准备测量计划和管控参数（属性对象不在工作线程中访问）
+    FitConfig config;
+    auto weight = IrlsCircleSolver::weightTypeFromString(prop_obj_->propValue("weight_type").toString().toStdString());
+    double permissibleErr = prop_obj_->propValue("permissibleErr").toDouble();
+    // 连续跟踪：以上一帧结果热启动，并让圆环中心缓慢跟随零件漂移
+    const bool temporal = prop_obj_->propValue("temporal_mode").toString() == "开启";
+    const double followRate = std::min(1.0, std::max(0.0, prop_obj_->propValue("follow_rate").toDouble()));
+    // 离群点较多时先做3点一致性预筛选，其内点集和圆作为IRLS初值
+    const bool consensus = prop_obj_->propValue("consensus_prestage").toString() == "开启";
+    const double consensusThreshold = std::max(0.1, prop_obj_->propValue("consensus_threshold").toDouble());
+    // 几何LM直接最小化点到圆的距离，小圆弧/噪声各向异性时比代数IRLS更准确
+    const bool geometric = prop_obj_->propValue("fit_method").toString() == "几何LM";
+    // 同心双圆：一次测量得到内外两圆及壁厚（此模式下不使用自适应密度/预筛选）
+    const bool concentric = prop_obj_->propValue("concentric_mode").toString() == "开启";
+    const bool sharedCenter = prop_obj_->propValue("shared_center").toString() == "开启";
+    AdaptiveDensity adaptive;
+    adaptive.enabled = prop_obj_->propValue("adaptive_density").toString() == "开启";
+    adaptive.coarseCount = prop_obj_->propValue("coarse_handle_num").toInt();
+    adaptive.targetUncertainty = prop_obj_->propValue("target_uncertainty").toDouble();
+    std::vector<RingTolerance> tolerances(rings_.size());
+    std::vector<Pointf> measureCenters(rings_.size());
+    std::vector<Pointf> alignedCenters(rings_.size());
+    bool anyNative = false;
+    int planThreads = 1;
+    for (size_t i = 0; i < rings_.size(); ++i) {
+        RingContext& ring = *rings_[i];
+        Pointf center = ring.center;
+        if (!alignment.isIdentity()) {
+            double cx = 0.0, cy = 0.0;
+            alignment.mapPoint(ring.center.x, ring.center.y, cx, cy);
+            center = Pointf(cx, cy);
+        }
+        const Pointf alignedCenter = center;
+        if (temporal) {
+            center = Pointf(center.x + ring.drift.x, center.y + ring.drift.y);
+        }
+        else {
+            ring.hasLast = false;
+            ring.drift = Pointf();
+        }
+        measureCenters[i] = center;
+        alignedCenters[i] = alignedCenter;
+        // 圆弧的起始角随位姿旋转
+        double startAngle = ring.startAngle;
+        if (ring.spanAngle < 360.0 && !alignment.isIdentity()) {
+            startAngle = alignment.mapAngleDeg(startAngle);
+        }
+        outputs[i].err = ensureCaliperPlan(ring.plan, width.I(), height.I(), center, ring.innerRadius, ring.outerRadius,
+            startAngle, ring.spanAngle);
+        anyNative = anyNative || (ring.plan.valid && ring.plan.nativeBackend);
+        planThreads = std::max(planThreads, ring.plan.threads);
+
+        // 管控参数：优先使用单独配置；第一个圆环兼容原有的标准圆属性；其余以绘制的圆环为标准
+        // 标准圆心在模板图像上给出，与圆环中心一样按位姿变换到当前图像（不跟随连续跟踪的漂移）
+        if (i < ringTolerances_.size() && ringTolerances_[i].valid) {
+            tolerances[i] = ringTolerances_[i];
+            alignment.mapPoint(ringTolerances_[i].cx, ringTolerances_[i].cy, tolerances[i].cx, tolerances[i].cy);
+        }
+        else if (i == 0) {
+            alignment.mapPoint(prop_obj_->propValue("std_cx").toInt(), prop_obj_->propValue("std_cy").toInt(),
+                tolerances[i].cx, tolerances[i].cy);
+            tolerances[i].radius = prop_obj_->propValue("std_radius").toInt();
+            tolerances[i].permissibleErr = permissibleErr;
+        }
+        else {
+            tolerances[i].cx = alignedCenter.x;
+            tolerances[i].cy = alignedCenter.y;
+            tolerances[i].radius = 0.5 * (ring.innerRadius + ring.outerRadius);
+            tolerances[i].permissibleErr = permissibleErr;
+        }
+    }
+    // 原生后端共用一次灰度转换
+    HObject measureImg = anyNative ? toGrayByteImage(hSrc) : hSrc;
+
+    // 并行阶段：圆环之间并行，线程预算在圆环与卡尺之间分配，避免嵌套超订
+    const int ringWorkers = static_cast<int>(std::min<size_t>(planThreads, rings_.size()));
+    const int caliperThreads = std::max(1, planThreads / std::max(1, ringWorkers));
+    parallelFor(rings_.size(), ringWorkers, [&](size_t i, int) {
+        RingMeasurement& out = outputs[i];
+        if (out.err != 0) {
+            return;
+        }
+        RingContext& ring = *rings_[i];
+        const Pointf& center = measureCenters[i];
+        const Pointf& alignedCenter = alignedCenters[i];
+        if (concentric) {
+            out.concentric = true;
+            out.err = measureConcentricPts(measureImg, ring.plan, center, &out.pts, &out.outerPts, caliperThreads);
+        }
+        else {
+            out.err = adaptive.enabled
+                ? measureCirclePtsAdaptive(measureImg, ring.plan, ring.solver, config, weight, adaptive, &out.pts, caliperThreads)
+                : measureCirclePts(measureImg, ring.plan, &out.pts, caliperThreads);
+        }
+        if (out.err != 0) {
+            return;
+        }
+        if (concentric) {
+            if (!ring.solver.fitConcentric(out.pts, out.outerPts, config, weight, sharedCenter, &out.circle, &out.outerCircle)) {
+                out.circle = Circle(0.0, 0.0, 0.0);
+                out.outerCircle = Circle(0.0, 0.0, 0.0);
+            }
+        }
+        else if (consensus) {
+            out.circle = ring.solver.fitConsensus(out.pts, config, weight, consensusThreshold, 500, geometric);
+        }
+        else if (temporal && ring.hasLast) {
+            Circle seed = warmStartSeed(ring, alignedCenter);
+            out.circle = geometric ? ring.solver.fitGeometric(out.pts, config, weight, &seed)
+                : ring.solver.fitWarm(out.pts, config, weight, seed);
+        }
+        else if (ring.spanAngle < 360.0) {
+            // 圆弧点集的中位数落在弧上而非圆心附近，以ROI圆作为IRLS初值；几何LM再从IRLS结果精修
+            Circle seed(center.x, center.y, 0.5 * (ring.innerRadius + ring.outerRadius));
+            out.circle = ring.solver.fitWarm(out.pts, config, weight, seed);
+            if (geometric) {
+                Circle refined = out.circle;
+                out.circle = ring.solver.fitGeometric(out.pts, config, weight, &refined);
+            }
+        }
+        else if (geometric) {
+            out.circle = ring.solver.fitGeometric(out.pts, config, weight);
+        }
+        else {
+            out.circle = ring.solver.fit(out.pts, config, weight);
+        }
+        if (temporal) {
+            if (out.pts.size() >= 3 && out.circle.radius > 0) {
+                // 记录相对对齐后圆环中心的结果（测量圆心含漂移，每帧都在变化），位姿对齐变化时仍可作为初值
+                ring.last = out.circle;
+                ring.last.center_x -= alignedCenter.x;
+                ring.last.center_y -= alignedCenter.y;
+                ring.hasLast = true;
+                // 圆环中心按跟随系数向拟合圆心移动，累计偏移限制在半个圆环宽度内
+                double limit = 0.5 * (ring.outerRadius - ring.innerRadius);
+                double dx = ring.drift.x + followRate * (out.circle.center_x - center.x);
+                double dy = ring.drift.y + followRate * (out.circle.center_y - center.y);
+                double len = std::sqrt(dx * dx + dy * dy);
+                if (len > limit && len > 0) {
+                    dx *= limit / len;
+                    dy *= limit / len;
+                }
+                ring.drift = Pointf(dx, dy);
+            }
+            else {
+                ring.hasLast = false;
+            }
+        }
+        const RingTolerance& tol = tolerances[i];
+        // 同心双圆模式下标准半径对应内外圆中较接近的一个
+        double radius = out.circle.radius;
+        if (out.concentric && fabs(out.outerCircle.radius - tol.radius) < fabs(radius - tol.radius)) {
+            radius = out.outerCircle.radius;
+        }
+        // 边缘点不足3个时拟合结果无意义（热启动时可能原样返回初值），一律判NG
+        out.ok = out.pts.size() >= 3 && out.circle.radius > 0
+            && fabs(out.circle.center_x - tol.cx) <= tol.permissibleErr
+            && fabs(out.circle.center_y - tol.cy) <= tol.permissibleErr
+            && fabs(radius - tol.radius) <= tol.permissibleErr;
+    });
+    return outputs;
+}
+
+Circle CircleFitAlgorithm::warmStartSeed(const RingContext& ring, const Pointf& alignedCenter)
+{
+    Circle seed = ring.last;
+    seed.center_x += alignedCenter.x;
+    seed.center_y += alignedCenter.y;
+    return seed;
+}
+
+void CircleFitAlgorithm::addRingResult(AlgorithmResult& result, size_t index, const RingMeasurement& ring, bool withRadius, int fontSize)
+{
+    // 边缘点合并为一个图形，不再每个点单独创建ResultRect
+    ResultPointBatch edgePts;
+    edgePts.reserve(ring.pts.size());
+    for (const auto& pt : ring.pts) {
+        edgePts.add(pt.x, pt.y);
+    }
+    if (auto shape = edgePts.toShape(Qt::red)) {
+        result.addResultShape(shape);
+    }
+    auto resultCircle = std::make_shared<ResultCircle>(QPointF(ring.circle.center_x, ring.circle.center_y), ring.circle.radius);
+    result.addResultShape(resultCircle);
+    if (ring.concentric) {
+        ResultPointBatch outerPts;
+        outerPts.reserve(ring.outerPts.size());
+        for (const auto& pt : ring.outerPts) {
+            outerPts.add(pt.x, pt.y);
+        }
+        if (auto shape = outerPts.toShape(Qt::blue)) {
+            result.addResultShape(shape);
+        }
+        result.addResultShape(std::make_shared<ResultCircle>(QPointF(ring.outerCircle.center_x, ring.outerCircle.center_y), ring.outerCircle.radius));
+    }
+
+    // 增加一个十字标记
+    auto coordinate = std::make_shared<ResultCoordinate>(QPointF(ring.circle.center_x, ring.circle.center_y), 0);
+    result.addResultShape(coordinate);
+
+    QString content = withRadius ?
+        QString("center: x=%1， y=%2, r=%3").arg(ring.circle.center_x).arg(ring.circle.center_y).arg(ring.circle.radius) :
+        QString("center: x=%1， y=%2").arg(ring.circle.center_x).arg(ring.circle.center_y);
+    if (ring.concentric) {
+        // 壁厚 = 外圆半径 - 内圆半径
+        content = QString("center: x=%1， y=%2, r_in=%3, r_out=%4, t=%5").arg(ring.circle.center_x).arg(ring.circle.center_y)
+            .arg(ring.circle.radius).arg(ring.outerCircle.radius).arg(ring.outerCircle.radius - ring.circle.radius);
+    }
+    if (rings_.size() > 1) {
+        content = QString("[%1] ").arg(index + 1) + content;
+    }
+    auto textItem = std::make_shared<ResultText>(content, QPointF(0, index * (fontSize + 8)), fontSize);
+    result.addResultShape(textItem);
+}
+
 AlgorithmResult CircleFitAlgorithm::test(const AlgorithmInput& input)
 {
     AlgorithmResult result;
-    uint8_t err = 0;
     int idx = prop_obj_->enumIndex("image_source");
     if (idx >= input.imageCount()) {
         result.setCode(-1);
@@ -711,66 +1154,37 @@ AlgorithmResult CircleFitAlgorithm::test(const AlgorithmInput& input)
     }
 
     hImg = input.getImageAsHObject(idx);
-    /*HalconCpp::HTuple channels;
-    CountChannels(hImg, &channels);
-    int chCount = channels.I();
-    qDebug() << "[HairyFabric] Detected Channels:" << chCount;*/
     if (!hImg.IsInitialized()) {
         result.setCode(-2);
         result.setMsg("获取图片失败");
         return result;
     }
 
-    QVector<std::shared_ptr<RoiShape>> roishpes = input.roiShapes();
-    auto it = std::find_if(roishpes.begin(), roishpes.end(),
-        [](const std::shared_ptr<RoiShape>& shapePtr) {
-            return shapePtr->type() == RoiShape::Ring;
-    });
-
-    std::shared_ptr<RoiRing> ring = nullptr;
-    if (it != roishpes.end()) {
-        ring = std::static_pointer_cast<RoiRing>(*it);
+    // 界面测试时属性可能已被修改，按当前绘制的所有圆环重新生成测量计划
+    std::vector<std::unique_ptr<RingContext>> rings;
+    for (const auto& shape : input.roiShapes()) {
+        auto ctx = ringFromShape(shape);
+        if (ctx) {
+            rings.push_back(std::move(ctx));
+        }
     }
-
-    if (!ring) {
+    if (rings.empty()) {
         result.setCode(-3);
-        result.setMsg("请先绘制ring roi");
-        return result;
-    }
-
-    std::vector<Pointf> allPts;
-    center_.x = ring->center().x();
-    center_.y = ring->center().y();
-
-    inner_radius_ = ring->innerRadius();
-    outer_radius_ = ring->outterRadius();
-
-    err = measureCirclePts(hImg, center_, inner_radius_, outer_radius_, &allPts);
-    if (err != 0) {
-        result.setCode(err);
-        result.setMsg("卡尺测量算法出错");
+        result.setMsg("请先绘制ring或arc ring roi");
         return result;
     }
+    releaseRings();
+    rings_ = std::move(rings);
 
-    for (auto pt : allPts) {
-        auto rect = std::make_shared<ResultRect>(QRectF(pt.x, pt.y, 4, 4), Qt::red);
-        result.addResultShape(rect);
+    auto measurements = measureRings(hImg, RoiAlignment());
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        if (measurements[i].err != 0) {
+            result.setCode(measurements[i].err);
+            result.setMsg(QString("圆环%1卡尺测量算法出错").arg(i + 1));
+            return result;
+        }
+        addRingResult(result, i, measurements[i], false, 48);
     }
-    // 测量圆的大小：
-    bool cirStatus;
-    Circle result2 = FitCircle(allPts, cirStatus, "plus");
-
-    auto resultCircle = std::make_shared<ResultCircle>(QPointF(result2.center_x, result2.center_y), result2.radius);
-    result.addResultShape(resultCircle);
-
-    // 增加一个十字标记
-    auto coordinate = std::make_shared<ResultCoordinate>(QPointF(result2.center_x, result2.center_y), 0);
-    result.addResultShape(coordinate);
-
-    QString content = QString("center: x=%1， y=%2").arg(result2.center_x).arg(result2.center_y);
-    auto textItem = std::make_shared<ResultText>(content, QPointF(0, 0), 48);
-    result.addResultShape(textItem);
-
     return result;
 }
 
@@ -790,45 +1204,31 @@ AlgorithmResult CircleFitAlgorithm::run(const AlgorithmContext& context)
         return result;
     }
 
-    if (!init_param_status_) {
+    if (!init_param_status_ || rings_.empty()) {
         result.setCode(-3);
         result.setMsg("初始化参数失败");
         return result;
     }
 
-    std::vector<Pointf> allPts;
-    int err = 0;
-    err = measureCirclePts(hImg, center_, inner_radius_, outer_radius_, &allPts);
-    if (err != 0) {
-        result.setCode(err);
-        result.setMsg("圆拟合卡尺测量算法出错");
-        return result;
-    }    
-
-    for (auto pt : allPts) {
-        auto rect = std::make_shared<ResultRect>(QRectF(pt.x, pt.y, 4, 4), Qt::red);
-        result.addResultShape(rect);
+    // 所有圆环共用一次图像转换；圆环中心按上游匹配步骤写入上下文的位姿对齐（圆环旋转不变，只需平移中心）
+    RoiAlignment alignment = RoiAlignment::fromVariant(context.getData(RoiAlignment::contextKey(), QVariant()));
+    auto measurements = measureRings(hImg, alignment);
+    bool allOK = true;
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        if (measurements[i].err != 0) {
+            result.setCode(measurements[i].err);
+            result.setMsg(QString("圆环%1圆拟合卡尺测量算法出错").arg(i + 1));
+            return result;
+        }
+        addRingResult(result, i, measurements[i], true, 32);
+        allOK = allOK && measurements[i].ok;
     }
-    // 测量圆的大小：
-    bool cirStatus;
-    Circle result2 = FitCircle(allPts, cirStatus, "plus");
 
-    auto resultCircle = std::make_shared<ResultCircle>(QPointF(result2.center_x, result2.center_y), result2.radius);
-    result.addResultShape(resultCircle);
-
-    // 增加一个十字标记
-    auto coordinate = std::make_shared<ResultCoordinate>(QPointF(result2.center_x, result2.center_y), 0);
-    result.addResultShape(coordinate);
-
-    QString content = QString("center: x=%1， y=%2, r=%3").arg(result2.center_x).arg(result2.center_y).arg(result2.radius);
-    auto textItem = std::make_shared<ResultText>(content, QPointF(0, 0), 32);
-    result.addResultShape(textItem);
-
-    // 新增圆拟合管控----超过设置的值则报失败
-    if (cirStatus) {
+    // 新增圆拟合管控----任一圆环超过设置的值则报失败
+    if (allOK) {
         result.setResultType(ResultType::OK);
     } else {
         result.setResultType(ResultType::NG);
     }
     return result;
-}
\ No newline at end of file
+}
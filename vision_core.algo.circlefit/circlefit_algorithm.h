@@ -10,10 +10,13 @@
 #include <halconCpp/HalconCpp.h>
 
 #include "define.h"
+#include "caliper_engine.h"
+#include "irls_circle_solver.h"
 #include "ialgorithm.h"
 #include "configurable_object.h"
 #include "property_editor_widget.h"
 #include "image_editor.h"
+#include "roi_alignment.h"
 
 
 /*
@@ -21,6 +24,9 @@
 */
 class CircleFitAlgorithm: public IAlgorithm
 {
+    // 功能测试需要检查连续跟踪的热启动初值
+    friend class VisionAlgoTest;
+
   public:
     // 圆拟合算法构造函数
     CircleFitAlgorithm();
@@ -40,6 +46,84 @@ class CircleFitAlgorithm: public IAlgorithm
     virtual AlgorithmResult run(const AlgorithmContext& input) override;
     // 参数配置界面
     AlgorithmResult test(const AlgorithmInput& input);
+    // 批量圆拟合（SoA布局）：offsets为圆数量+1项的偏移表，xs/ys为所有点坐标连续存储
+    // threads为0时使用硬件线程数，返回与offsets顺序一致的拟合结果
+    std::vector<Circle> fitCircleBatch(const std::vector<int>& offsets, const std::vector<double>& xs,
+        const std::vector<double>& ys, int threads = 0);
+
+private:
+    // 卡尺测量计划：每个卡尺的测量句柄及其相对圆心的偏移，测量参数只在生成时读取一次
+    // 原生后端不创建Halcon句柄，使用geometries生成的CaliperEngine采样表
+    struct CaliperPlan {
+        bool valid = false;
+        bool nativeBackend = false;
+        int threads = 1;
+        int width = 0;
+        int height = 0;
+        double centerRow = 0.0;
+        double centerCol = 0.0;
+        float innerRadius = 0.0f;
+        float outterRadius = 0.0f;
+        // 圆弧范围（度，ROI坐标系，与RoiArcRing一致），spanAngle >= 360为整圆
+        double startAngle = 0.0;
+        double spanAngle = 360.0;
+        double sigma = 1.0;
+        int threshold = 0;
+        std::string transition;
+        std::string select;
+        int handleNum = 0;
+        bool insideOut = false;
+        std::vector<double> rowOffsets;
+        std::vector<double> colOffsets;
+        std::vector<HalconCpp::HTuple> handles;
+        std::vector<CaliperEngine::Geometry> geometries;
+        CaliperEngine::EdgeOptions edgeOptions;
+        CaliperEngine engine;
+    };
+
+    // 单个圆环的管控参数（标准圆心、半径及允许偏差）
+    struct RingTolerance {
+        bool valid = false;
+        double cx = 0.0;
+        double cy = 0.0;
+        double radius = 0.0;
+        double permissibleErr = 0.0;
+    };
+
+    // 单个圆环的配置与运行状态：测量计划和求解器按圆环独立，圆环之间可并行
+    struct RingContext {
+        Pointf center;
+        float innerRadius = 0.0f;
+        float outerRadius = 0.0f;
+        // RoiArcRing的可见圆弧（度），RoiRing为整圆
+        double startAngle = 0.0;
+        double spanAngle = 360.0;
+        CaliperPlan plan;
+        IrlsCircleSolver solver;
+        // 连续跟踪状态：上一帧拟合结果相对对齐后圆环中心（不含漂移）的偏移，以及圆环跟随漂移的累计偏移
+        bool hasLast = false;
+        Circle last;
+        Pointf drift;
+    };
+
+    // 自适应卡尺密度：先测稀疏卡尺并拟合，只在无边缘/残差大的扇区加密，拟合不确定度达标即停止
+    struct AdaptiveDensity {
+        bool enabled = false;
+        int coarseCount = 12;               // 初始均匀卡尺数（最大为handleNum）
+        double targetUncertainty = 0.05;    // 圆心/半径标准差目标（像素）
+        int maxRounds = 6;                  // 最大加密轮数
+    };
+
+    // 单个圆环的测量结果（同心双圆模式下pts/circle为内圆，outerPts/outerCircle为外圆）
+    struct RingMeasurement {
+        int err = 0;
+        bool ok = false;
+        std::vector<Pointf> pts;
+        Circle circle;
+        bool concentric = false;
+        std::vector<Pointf> outerPts;
+        Circle outerCircle;
+    };
 
 private:
     void setupProperties();
@@ -49,8 +133,43 @@ private:
     Circle FitCircle(const std::vector<Pointf>& points, const FitConfig& config);
     // 工具函数
     double CalculateRMSE(const std::vector<Pointf>& points, double center_x, double center_y, double radius);
-    // 卡尺测量用于圆拟合的函数
-    int measureCirclePts(HalconCpp::HObject& hSrc, Pointf& center, const float& innerRadius, const float& outterRadius, std::vector<Pointf>* pts);
+    // 卡尺测量用于圆拟合的函数（使用已准备好的测量计划，maxThreads>0时限制卡尺并行数）
+    int measureCirclePts(HalconCpp::HObject& hSrc, CaliperPlan& plan, std::vector<Pointf>* pts, int maxThreads = 0);
+    // 只测量indices指定的卡尺，边缘点写入caliperPts对应槽位（按卡尺角度索引），amplitudes非空时同时输出边缘幅值（符号即极性）
+    void measureCalipers(HalconCpp::HObject& hSrc, CaliperPlan& plan, const std::vector<size_t>& indices,
+        std::vector<std::vector<Pointf>>& caliperPts, int threads, std::vector<std::vector<double>>* amplitudes = nullptr);
+    // 原生卡尺引擎测量（不调用MeasurePos）
+    void measureCalipersNative(HalconCpp::HObject& hSrc, CaliperPlan& plan, const std::vector<size_t>& indices,
+        std::vector<std::vector<Pointf>>& caliperPts, int threads, std::vector<std::vector<double>>* amplitudes);
+    // 同心双圆：一次测量所有卡尺的全部边缘，按半径聚为内外两类、每类取主极性，
+    // 每个卡尺每类保留幅值最大的一个边缘点
+    int measureConcentricPts(HalconCpp::HObject& hSrc, CaliperPlan& plan, const Pointf& center,
+        std::vector<Pointf>* innerPts, std::vector<Pointf>* outerPts, int maxThreads = 0);
+    // 自适应卡尺密度测量，返回所用卡尺的全部边缘点
+    int measureCirclePtsAdaptive(HalconCpp::HObject& hSrc, CaliperPlan& plan, IrlsCircleSolver& solver, const FitConfig& config,
+        IrlsCircleSolver::WeightType weight, const AdaptiveDensity& adaptive, std::vector<Pointf>* pts, int maxThreads = 0);
+    // 转换为原生引擎所需的8位单通道图像
+    static HalconCpp::HObject toGrayByteImage(const HalconCpp::HObject& hSrc);
+    // 生成卡尺测量计划（测量句柄 + 测量参数），卡尺只布置在startAngle起spanAngle范围的圆弧上
+    int buildCaliperPlan(CaliperPlan& plan, int width, int height, const Pointf& center, float innerRadius, float outterRadius,
+        double startAngle = 0.0, double spanAngle = 360.0);
+    // 从属性读取测量参数（极性、点模式、阈值、卡尺数、方向、后端、线程数）
+    void readCaliperOptions(CaliperPlan& plan) const;
+    // 测量参数、圆环、圆弧或图像尺寸变化时重建测量计划，仅圆心移动时平移已有句柄
+    int ensureCaliperPlan(CaliperPlan& plan, int width, int height, const Pointf& center, float innerRadius, float outterRadius,
+        double startAngle = 0.0, double spanAngle = 360.0);
+    // 释放卡尺测量计划，参数变化时调用
+    static void releaseCaliperPlan(CaliperPlan& plan);
+    // 释放所有圆环
+    void releaseRings();
+    // 由RoiRing/RoiArcRing生成圆环配置，其他形状返回空
+    static std::unique_ptr<RingContext> ringFromShape(const std::shared_ptr<RoiShape>& shape);
+    // 测量并拟合所有圆环（同一张图像，圆环之间并行）
+    std::vector<RingMeasurement> measureRings(HalconCpp::HObject& hSrc, const RoiAlignment& alignment);
+    // 连续跟踪的热启动初值：上一帧结果按对齐后的圆环中心还原到当前图像
+    static Circle warmStartSeed(const RingContext& ring, const Pointf& alignedCenter);
+    // 输出单个圆环的显示结果
+    void addRingResult(AlgorithmResult& result, size_t index, const RingMeasurement& ring, bool withRadius, int fontSize);
     // 不需要声明构造函数，编译器会自动生成
     Circle fitCircleSimpleLS(const std::vector<Pointf>& points);
     // 私有方法
@@ -60,23 +179,19 @@ private:
 
     double geometricResidual(double x, double y, double cx, double cy, double r);
 
-    static double HuberWeight(double residual, double k);
-
-    static double TukeyWeight(double residual, double k);
-
-    // 新增测试函数--更鲁棒的初始估计
-    void computeSmallDataInitialEstimate(const std::vector<Pointf>& points, double& center_x, double& center_y, double& radius);
-
     // 验证圆的一致性函数
     double validateCircleConsistency(const std::vector<Pointf>& points, double center_x, double center_y, double radius);
 
   private:
     ConfigurableObject* prop_obj_;
     HalconCpp::HObject hImg;
-    Pointf  center_;
-    double inner_radius_;
-    double outer_radius_;
     bool  init_param_status_;
+    // 所有圆环（按ROI顺序）
+    std::vector<std::unique_ptr<RingContext>> rings_;
+    // 各圆环单独配置的管控参数（按圆环顺序，来自配方的ring_tolerances），界面测试重建圆环时保留
+    std::vector<RingTolerance> ringTolerances_;
+    // IRLS求解器（复用工作区）
+    IrlsCircleSolver solver_;
 };
 
 #endif // CIRCLE_FIT_ALGO_RITHM_H
\ No newline at end of file
@@ -0,0 +1,812 @@
+#include "irls_circle_solver.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <future>
+#include <random>
+
+
+namespace {
+    // Tukey权重
+    struct TukeyPolicy {
+        static const char* name() { return "tukey"; }
+        static inline double weight(double residual, double k)
+        {
+            double r_over_k = residual / k;
+            if (std::abs(r_over_k) <= 1.0) {
+                double tmp = 1.0 - r_over_k * r_over_k;
+                return tmp * tmp;
+            }
+            return 0.0;
+        }
+    };
+
+    // Huber权重
+    struct HuberPolicy {
+        static const char* name() { return "huber"; }
+        static inline double weight(double residual, double k)
+        {
+            double abs_r = std::abs(residual);
+            return (abs_r <= k) ? 1.0 : k / abs_r;
+        }
+    };
+
+    // 三点确定的圆，共线或接近共线时返回false
+    inline bool circleFrom3(double x1, double y1, double x2, double y2, double x3, double y3, Circle* c)
+    {
+        double ax = x2 - x1, ay = y2 - y1;
+        double bx = x3 - x1, by = y3 - y1;
+        double d = 2.0 * (ax * by - ay * bx);
+        double scale = (ax * ax + ay * ay) * (bx * bx + by * by);
+        if (std::abs(d) < 1e-9 || d * d < 1e-12 * scale) {
+            return false;
+        }
+        double a2 = ax * ax + ay * ay;
+        double b2 = bx * bx + by * by;
+        double ux = (by * a2 - ay * b2) / d;
+        double uy = (ax * b2 - bx * a2) / d;
+        c->center_x = x1 + ux;
+        c->center_y = y1 + uy;
+        c->radius = std::sqrt(ux * ux + uy * uy);
+        return std::isfinite(c->radius);
+    }
+
+    // 线性时间取第k小值（会打乱data顺序）
+    inline double selectNth(double* data, int n, int k)
+    {
+        std::nth_element(data, data + k, data + n);
+        return data[k];
+    }
+}
+
+IrlsCircleSolver::WeightType IrlsCircleSolver::weightTypeFromString(const std::string& name)
+{
+    return name == "huber" ? Huber : Tukey;
+}
+
+double IrlsCircleSolver::estimateUncertainty(const std::vector<Pointf>& points, const Circle& circle)
+{
+    const int n = static_cast<int>(points.size());
+    const double inf = std::numeric_limits<double>::infinity();
+    if (n < 4 || !(circle.radius > 0)) {
+        return inf;
+    }
+    std::vector<double> absRes(n);
+    for (int i = 0; i < n; ++i) {
+        double dx = points[i].x - circle.center_x;
+        double dy = points[i].y - circle.center_y;
+        absRes[i] = std::abs(std::sqrt(dx * dx + dy * dy) - circle.radius);
+    }
+    std::vector<double> sorted(absRes);
+    double mad = selectNth(sorted.data(), n, n / 2);
+    double cutoff = std::max(3.0 * 1.4826 * mad, 1e-6);
+
+    Eigen::Matrix3d jtj = Eigen::Matrix3d::Zero();
+    double sumSq = 0.0;
+    int m = 0;
+    for (int i = 0; i < n; ++i) {
+        if (absRes[i] > cutoff) {
+            continue;
+        }
+        double dx = points[i].x - circle.center_x;
+        double dy = points[i].y - circle.center_y;
+        double d = std::sqrt(dx * dx + dy * dy);
+        if (d < 1e-12) {
+            continue;
+        }
+        Eigen::Vector3d j(-dx / d, -dy / d, -1.0);
+        jtj += j * j.transpose();
+        sumSq += absRes[i] * absRes[i];
+        ++m;
+    }
+    if (m < 4) {
+        return inf;
+    }
+    Eigen::FullPivLU<Eigen::Matrix3d> lu(jtj);
+    if (!lu.isInvertible()) {
+        return inf;
+    }
+    double sigma2 = sumSq / (m - 3);
+    Eigen::Vector3d var = lu.inverse().diagonal() * sigma2;
+    return std::sqrt(std::max(0.0, var.maxCoeff()));
+}
+
+Circle IrlsCircleSolver::fitSimpleLS(const std::vector<Pointf>& points)
+{
+    // 简单的线性最小二乘圆拟合
+    const int n = static_cast<int>(points.size());
+    if (n < 3) {
+        return Circle(0, 0, 0);
+    }
+    Eigen::MatrixXd A(n, 3);
+    Eigen::VectorXd b(n);
+    for (int i = 0; i < n; i++) {
+        double x = points[i].x;
+        double y = points[i].y;
+        A(i, 0) = x;
+        A(i, 1) = y;
+        A(i, 2) = 1.0;
+        b(i) = x * x + y * y;
+    }
+    Eigen::Vector3d params = A.colPivHouseholderQr().solve(b);
+    double center_x = params(0) / 2.0;
+    double center_y = params(1) / 2.0;
+    double radius_sq = params(2) + center_x * center_x + center_y * center_y;
+    double radius = (radius_sq > 0) ? std::sqrt(radius_sq) : 0.0;
+    double error = 0.0;
+    for (const auto& p : points) {
+        double dx = p.x - center_x;
+        double dy = p.y - center_y;
+        double res = std::sqrt(dx * dx + dy * dy) - radius;
+        error += res * res;
+    }
+    Circle result(center_x, center_y, radius);
+    result.error = std::sqrt(error / n);
+    result.method = "SimpleLS";
+    result.IsConverged = true;
+    return result;
+}
+
+void IrlsCircleSolver::loadPoints(const std::vector<Pointf>& points)
+{
+    if (x_.size() < points.size()) {
+        x_.resize(points.size());
+        y_.resize(points.size());
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+        x_[i] = points[i].x;
+        y_[i] = points[i].y;
+    }
+}
+
+Circle IrlsCircleSolver::fit(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight)
+{
+    loadPoints(points);
+    return fit(x_.data(), y_.data(), static_cast<int>(points.size()), config, weight);
+}
+
+Circle IrlsCircleSolver::fitWarm(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight, const Circle& seed)
+{
+    loadPoints(points);
+    const int n = static_cast<int>(points.size());
+    if (weight == Huber) {
+        return fitImpl<HuberPolicy>(x_.data(), y_.data(), n, config, &seed);
+    }
+    return fitImpl<TukeyPolicy>(x_.data(), y_.data(), n, config, &seed);
+}
+
+Circle IrlsCircleSolver::fit(const double* x, const double* y, int n, const FitConfig& config, WeightType weight)
+{
+    if (weight == Huber) {
+        return fitImpl<HuberPolicy>(x, y, n, config, nullptr);
+    }
+    return fitImpl<TukeyPolicy>(x, y, n, config, nullptr);
+}
+
+int IrlsCircleSolver::findConsensus(const double* x, const double* y, int n, double inlierThreshold, int maxHypotheses, Circle* best)
+{
+    if (n < 3) {
+        return 0;
+    }
+    // 固定种子保证同一组点结果可复现
+    std::mt19937 rng(static_cast<unsigned int>(n) * 2654435761u);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    const double confidence = 0.99;
+    int bestCount = 0;
+    double bestCost = std::numeric_limits<double>::max();
+    int required = maxHypotheses;
+    for (int h = 0; h < required && h < maxHypotheses; ++h) {
+        int i1 = pick(rng), i2 = pick(rng), i3 = pick(rng);
+        if (i1 == i2 || i1 == i3 || i2 == i3) {
+            continue;
+        }
+        Circle hyp{};
+        if (!circleFrom3(x[i1], y[i1], x[i2], y[i2], x[i3], y[i3], &hyp)) {
+            continue;
+        }
+        // 评分：内点数 + 内点残差和（并列时取残差小者）；剩余点全为内点也无法超过最优时提前放弃该假设
+        int count = 0;
+        double cost = 0.0;
+        for (int i = 0; i < n; ++i) {
+            double dx = x[i] - hyp.center_x;
+            double dy = y[i] - hyp.center_y;
+            double r = std::abs(std::sqrt(dx * dx + dy * dy) - hyp.radius);
+            if (r < inlierThreshold) {
+                ++count;
+                cost += r;
+            }
+            else if (count + (n - 1 - i) < bestCount) {
+                break;
+            }
+        }
+        if (count > bestCount || (count == bestCount && cost < bestCost)) {
+            bestCount = count;
+            bestCost = cost;
+            *best = hyp;
+            // 自适应终止：以当前内点率估计达到置信度所需的假设数
+            double w = static_cast<double>(bestCount) / n;
+            double w3 = w * w * w;
+            if (w3 >= 1.0 - 1e-12) {
+                break;
+            }
+            double needed = std::log(1.0 - confidence) / std::log(1.0 - w3);
+            if (needed < required) {
+                required = static_cast<int>(std::ceil(needed));
+            }
+        }
+    }
+    return bestCount >= 3 ? bestCount : 0;
+}
+
+Circle IrlsCircleSolver::fitConsensus(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight,
+    double inlierThreshold, int maxHypotheses, bool geometric)
+{
+    loadPoints(points);
+    const int n = static_cast<int>(points.size());
+    Circle best;
+    int count = findConsensus(x_.data(), y_.data(), n, inlierThreshold, maxHypotheses, &best);
+    if (count < 3) {
+        if (geometric) {
+            return refineGeometric(x_.data(), y_.data(), n, config, weight, nullptr);
+        }
+        return fit(x_.data(), y_.data(), n, config, weight);
+    }
+    // 只保留最优假设的内点，并以该假设为初值进行IRLS
+    inlierX_.resize(count);
+    inlierY_.resize(count);
+    int k = 0;
+    for (int i = 0; i < n && k < count; ++i) {
+        double dx = x_[i] - best.center_x;
+        double dy = y_[i] - best.center_y;
+        if (std::abs(std::sqrt(dx * dx + dy * dy) - best.radius) < inlierThreshold) {
+            inlierX_[k] = x_[i];
+            inlierY_[k] = y_[i];
+            ++k;
+        }
+    }
+    if (geometric) {
+        return refineGeometric(inlierX_.data(), inlierY_.data(), k, config, weight, &best);
+    }
+    if (weight == Huber) {
+        return fitImpl<HuberPolicy>(inlierX_.data(), inlierY_.data(), k, config, &best);
+    }
+    return fitImpl<TukeyPolicy>(inlierX_.data(), inlierY_.data(), k, config, &best);
+}
+
+Circle IrlsCircleSolver::fitGeometric(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight, const Circle* seed)
+{
+    loadPoints(points);
+    return refineGeometric(x_.data(), y_.data(), static_cast<int>(points.size()), config, weight, seed);
+}
+
+bool IrlsCircleSolver::algebraicFit(const double* x, const double* y, int n, Circle* circle)
+{
+    if (n < 3) {
+        return false;
+    }
+    double mean_x = 0.0, mean_y = 0.0;
+    for (int i = 0; i < n; ++i) {
+        mean_x += x[i];
+        mean_y += y[i];
+    }
+    mean_x /= n;
+    mean_y /= n;
+    Eigen::Matrix3d ata = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d atb = Eigen::Vector3d::Zero();
+    for (int i = 0; i < n; ++i) {
+        double u = x[i] - mean_x;
+        double v = y[i] - mean_y;
+        double z = u * u + v * v;
+        ata(0, 0) += u * u;
+        ata(0, 1) += u * v;
+        ata(0, 2) += u;
+        ata(1, 1) += v * v;
+        ata(1, 2) += v;
+        atb(0) += u * z;
+        atb(1) += v * z;
+        atb(2) += z;
+    }
+    ata(2, 2) = n;
+    ata(1, 0) = ata(0, 1);
+    ata(2, 0) = ata(0, 2);
+    ata(2, 1) = ata(1, 2);
+    Eigen::Vector3d params = ata.fullPivLu().solve(atb);
+    double cx = params(0) / 2.0;
+    double cy = params(1) / 2.0;
+    double r2 = params(2) + cx * cx + cy * cy;
+    if (!(r2 > 0) || !std::isfinite(r2)) {
+        return false;
+    }
+    circle->center_x = cx + mean_x;
+    circle->center_y = cy + mean_y;
+    circle->radius = std::sqrt(r2);
+    return true;
+}
+
+Circle IrlsCircleSolver::refineGeometric(const double* x, const double* y, int n, const FitConfig& config, WeightType weight, const Circle* seed)
+{
+    // 有初值时同样要求至少3个点，否则LM无约束，会原样返回初值
+    if (n < 3) {
+        return Circle(0.0, 0.0, 0.0, 0.0, 0, "LM", false);
+    }
+    Circle init;
+    if (seed != nullptr && seed->radius > 1e-6) {
+        init = *seed;
+    }
+    else if (!algebraicFit(x, y, n, &init)) {
+        return Circle(0.0, 0.0, 0.0, 0.0, 0, "LM", false);
+    }
+    if (weight == Huber) {
+        return refineGeometric<HuberPolicy>(x, y, n, config, init);
+    }
+    return refineGeometric<TukeyPolicy>(x, y, n, config, init);
+}
+
+template <typename WeightPolicy>
+Circle IrlsCircleSolver::refineGeometric(const double* x, const double* y, int n, const FitConfig& config, const Circle& init)
+{
+    if (static_cast<int>(residuals_.size()) < n) {
+        residuals_.resize(n);
+        scratch_.resize(n);
+    }
+    double* residuals = residuals_.data();
+    double* scratch = scratch_.data();
+    double cx = init.center_x, cy = init.center_y, r = init.radius;
+
+    // 由初值残差的四分位距估计尺度，迭代中保持k不变以保证代价单调下降
+    for (int i = 0; i < n; ++i) {
+        double dx = x[i] - cx;
+        double dy = y[i] - cy;
+        scratch[i] = std::abs(std::sqrt(dx * dx + dy * dy) - r);
+    }
+    double q3 = selectNth(scratch, n, 3 * n / 4);
+    double q1 = selectNth(scratch, 3 * n / 4, n / 4);
+    double iqr = q3 - q1;
+    double sigma = (iqr > 1e-6) ? iqr / 1.349 : 1.0;
+    const double k = 3.0 * config.k_factor * sigma;
+
+    // 计算残差和加权代价；weights写入scratch
+    auto evaluate = [&](double ccx, double ccy, double rr, bool updateWeights) {
+        double cost = 0.0;
+        for (int i = 0; i < n; ++i) {
+            double dx = x[i] - ccx;
+            double dy = y[i] - ccy;
+            double res = std::sqrt(dx * dx + dy * dy) - rr;
+            residuals[i] = res;
+            if (updateWeights) {
+                scratch[i] = WeightPolicy::weight(res, k);
+            }
+            cost += scratch[i] * res * res;
+        }
+        return cost;
+    };
+
+    double lambda = 1e-3;
+    int iter = 0;
+    bool converged = false;
+    double cost = evaluate(cx, cy, r, true);
+    for (iter = 0; iter < config.max_iterations; ++iter) {
+        // 解析雅可比：d(res)/d(cx, cy, r) = (-(x-cx)/d, -(y-cy)/d, -1)
+        Eigen::Matrix3d jtj = Eigen::Matrix3d::Zero();
+        Eigen::Vector3d jtr = Eigen::Vector3d::Zero();
+        for (int i = 0; i < n; ++i) {
+            double w = scratch[i];
+            if (w <= 0.0) {
+                continue;
+            }
+            double dx = x[i] - cx;
+            double dy = y[i] - cy;
+            double d = std::sqrt(dx * dx + dy * dy);
+            if (d < 1e-12) {
+                continue;
+            }
+            double j0 = -dx / d, j1 = -dy / d, j2 = -1.0;
+            double res = residuals[i];
+            jtj(0, 0) += w * j0 * j0;
+            jtj(0, 1) += w * j0 * j1;
+            jtj(0, 2) += w * j0 * j2;
+            jtj(1, 1) += w * j1 * j1;
+            jtj(1, 2) += w * j1 * j2;
+            jtj(2, 2) += w * j2 * j2;
+            jtr(0) += w * j0 * res;
+            jtr(1) += w * j1 * res;
+            jtr(2) += w * j2 * res;
+        }
+        jtj(1, 0) = jtj(0, 1);
+        jtj(2, 0) = jtj(0, 2);
+        jtj(2, 1) = jtj(1, 2);
+
+        // 阻尼步长，代价未下降时增大lambda重试
+        bool accepted = false;
+        double step = 0.0;
+        while (lambda < 1e10) {
+            Eigen::Matrix3d a = jtj;
+            a.diagonal() *= (1.0 + lambda);
+            Eigen::Vector3d delta = a.ldlt().solve(-jtr);
+            if (!delta.allFinite()) {
+                lambda *= 10.0;
+                continue;
+            }
+            double ncx = cx + delta(0), ncy = cy + delta(1), nr = r + delta(2);
+            // 试探步使用当前权重比较代价
+            double trial = 0.0;
+            for (int i = 0; i < n; ++i) {
+                double dx = x[i] - ncx;
+                double dy = y[i] - ncy;
+                double res = std::sqrt(dx * dx + dy * dy) - nr;
+                trial += scratch[i] * res * res;
+            }
+            if (trial <= cost && nr > 0) {
+                cx = ncx;
+                cy = ncy;
+                r = nr;
+                step = delta.cwiseAbs().maxCoeff();
+                lambda = std::max(lambda * 0.1, 1e-9);
+                accepted = true;
+                break;
+            }
+            lambda *= 10.0;
+        }
+        if (!accepted) {
+            // 无法继续下降，已处于极小点
+            converged = true;
+            ++iter;
+            break;
+        }
+        cost = evaluate(cx, cy, r, true);
+        if (step < config.tolerance) {
+            converged = true;
+            ++iter;
+            break;
+        }
+    }
+
+    double weightSum = 0.0, weighted = 0.0;
+    evaluate(cx, cy, r, true);
+    for (int i = 0; i < n; ++i) {
+        weightSum += scratch[i];
+        weighted += scratch[i] * residuals[i] * residuals[i];
+    }
+    Circle result(cx, cy, r);
+    result.iterations = iter;
+    result.error = weightSum > 0 ? std::sqrt(weighted / weightSum) : 0.0;
+    result.method = std::string("LM_(") + WeightPolicy::name() + ")";
+    result.IsConverged = converged;
+    return result;
+}
+
+void IrlsCircleSolver::fitBatch(const int* offsets, int count, const double* x, const double* y,
+    const FitConfig& config, WeightType weight, int threads, Circle* out)
+{
+    if (count <= 0) {
+        return;
+    }
+    // 每块连续若干个圆，减少原子操作并保持内存访问连续
+    const int chunk = 32;
+    const int chunks = (count + chunk - 1) / chunk;
+    const int workers = std::max(1, std::min(threads, chunks));
+    std::atomic<int> nextChunk(0);
+    auto worker = [&]() {
+        IrlsCircleSolver solver;
+        for (int c = nextChunk++; c < chunks; c = nextChunk++) {
+            const int end = std::min(count, (c + 1) * chunk);
+            for (int i = c * chunk; i < end; ++i) {
+                const int begin = offsets[i];
+                out[i] = solver.fit(x + begin, y + begin, offsets[i + 1] - begin, config, weight);
+            }
+        }
+    };
+    if (workers == 1) {
+        worker();
+        return;
+    }
+    std::vector<std::future<void>> futures;
+    futures.reserve(workers);
+    for (int w = 0; w < workers; ++w) {
+        futures.push_back(std::async(std::launch::async, worker));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+}
+
+template <typename WeightPolicy>
+Circle IrlsCircleSolver::fitImpl(const double* x, const double* y, int n, const FitConfig& config, const Circle* seed)
+{
+    if (n < 3) {
+        return Circle(0.0, 0.0, 0.0, 0.0, 0, std::string("IRLS_(") + WeightPolicy::name() + ")", false);
+    }
+    if (static_cast<int>(residuals_.size()) < n) {
+        residuals_.resize(n);
+        scratch_.resize(n);
+    }
+    double* residuals = residuals_.data();
+    double* scratch = scratch_.data();
+
+    // 平移原点到坐标均值，避免大坐标下法方程病态
+    double mean_x = 0.0, mean_y = 0.0;
+    for (int i = 0; i < n; ++i) {
+        mean_x += x[i];
+        mean_y += y[i];
+    }
+    mean_x /= n;
+    mean_y /= n;
+
+    double center_x = 0.0, center_y = 0.0, radius = 0.0;
+    if (seed != nullptr && seed->radius > 1e-6) {
+        // 热启动：直接使用上一帧结果作为初值
+        center_x = seed->center_x;
+        center_y = seed->center_y;
+        radius = seed->radius;
+    }
+    else {
+        // 初始估计：坐标中位数作为圆心，距离中位数作为半径
+        for (int i = 0; i < n; ++i) {
+            scratch[i] = x[i];
+        }
+        center_x = selectNth(scratch, n, n / 2);
+        for (int i = 0; i < n; ++i) {
+            scratch[i] = y[i];
+        }
+        center_y = selectNth(scratch, n, n / 2);
+        for (int i = 0; i < n; ++i) {
+            double dx = x[i] - center_x;
+            double dy = y[i] - center_y;
+            scratch[i] = std::sqrt(dx * dx + dy * dy);
+        }
+        radius = selectNth(scratch, n, n / 2);
+    }
+
+    int iter = 0;
+    bool converged = false;
+    double prev_err = std::numeric_limits<double>::max();
+    const int maxIterations = config.max_iterations;
+    for (iter = 0; iter < maxIterations; ++iter) {
+        // 几何距离残差
+        double sq_sum = 0.0;
+        for (int i = 0; i < n; ++i) {
+            double dx = x[i] - center_x;
+            double dy = y[i] - center_y;
+            double r = std::abs(std::sqrt(dx * dx + dy * dy) - radius);
+            residuals[i] = r;
+            sq_sum += r * r;
+        }
+        double cur_err = std::sqrt(sq_sum) / std::sqrt(static_cast<double>(n));
+        if (std::abs(prev_err - cur_err) <= config.tolerance || cur_err < config.tolerance) {
+            converged = true;
+            break;
+        }
+        prev_err = cur_err;
+
+        // 四分位距估计尺度：先取Q3，Q1只需在其左侧选择
+        std::copy(residuals, residuals + n, scratch);
+        double q3 = selectNth(scratch, n, 3 * n / 4);
+        double q1 = selectNth(scratch, 3 * n / 4, n / 4);
+        double iqr = q3 - q1;
+
+        // 自适应k：初期宽松、中期适中、后期严格；热启动时固定k，使迭代直接收敛到不动点
+        double adaptive_kFactor = config.k_factor;
+        if (seed != nullptr || iter < 3) {
+            adaptive_kFactor = 3.0 * config.k_factor;
+        }
+        else if (iter < 8) {
+            adaptive_kFactor = 2.0 * config.k_factor;
+        }
+        double sigma = (iqr > 1e-6) ? iqr / 1.349 : 1.0;
+        double k = adaptive_kFactor * sigma;
+
+        // 累加加权法方程 A^T W A p = A^T W b，A = [u, v, 1]，b = u^2 + v^2
+        Eigen::Matrix3d ata = Eigen::Matrix3d::Zero();
+        Eigen::Vector3d atb = Eigen::Vector3d::Zero();
+        for (int i = 0; i < n; ++i) {
+            double w = 0.0;
+            // 小数据集避免完全排除任何点
+            if (n < 15 && residuals[i] > 4.0 * k) {
+                w = 0.1;
+            }
+            else {
+                w = WeightPolicy::weight(residuals[i], k);
+            }
+            w = std::max(w, 1e-12);
+            double u = x[i] - mean_x;
+            double v = y[i] - mean_y;
+            double z = u * u + v * v;
+            ata(0, 0) += w * u * u;
+            ata(0, 1) += w * u * v;
+            ata(0, 2) += w * u;
+            ata(1, 1) += w * v * v;
+            ata(1, 2) += w * v;
+            ata(2, 2) += w;
+            atb(0) += w * u * z;
+            atb(1) += w * v * z;
+            atb(2) += w * z;
+        }
+        ata(1, 0) = ata(0, 1);
+        ata(2, 0) = ata(0, 2);
+        ata(2, 1) = ata(1, 2);
+
+        Eigen::Vector3d params;
+        Eigen::LDLT<Eigen::Matrix3d> ldlt(ata);
+        if (ldlt.info() == Eigen::Success && ldlt.isPositive()) {
+            params = ldlt.solve(atb);
+        }
+        else {
+            params = ata.fullPivLu().solve(atb);
+        }
+
+        double new_center_x = params(0) / 2.0;
+        double new_center_y = params(1) / 2.0;
+        double new_radius = std::sqrt(params(2) + new_center_x * new_center_x + new_center_y * new_center_y);
+        new_center_x += mean_x;
+        new_center_y += mean_y;
+        if (new_radius > 1e-6 && std::isfinite(new_radius)) {
+            // 阻尼更新，避免剧烈变化（热启动初值接近真值，不加阻尼）
+            const double damping = (seed != nullptr) ? 0.0 : 0.15;
+            double prev_cx = center_x, prev_cy = center_y, prev_r = radius;
+            center_x = damping * center_x + (1 - damping) * new_center_x;
+            center_y = damping * center_y + (1 - damping) * new_center_y;
+            radius = damping * radius + (1 - damping) * new_radius;
+            // 热启动时参数变化足够小即提前结束（冷启动保持原有收敛判据）
+            if (seed != nullptr) {
+                double delta = std::max(std::abs(center_x - prev_cx), std::max(std::abs(center_y - prev_cy), std::abs(radius - prev_r)));
+                if (delta < config.tolerance) {
+                    converged = true;
+                    ++iter;
+                    break;
+                }
+            }
+        }
+    }
+
+    Circle result(center_x, center_y, radius);
+    result.iterations = iter;
+    result.method = std::string("IRLS_(") + WeightPolicy::name() + ")";
+    result.IsConverged = converged;
+    return result;
+}
+
+bool IrlsCircleSolver::fitConcentric(const std::vector<Pointf>& inner, const std::vector<Pointf>& outer, const FitConfig& config,
+    WeightType weight, bool sharedCenter, Circle* innerCircle, Circle* outerCircle)
+{
+    if (inner.size() < 3 || outer.size() < 3) {
+        return false;
+    }
+    *innerCircle = fit(inner, config, weight);
+    *outerCircle = fit(outer, config, weight);
+    if (!sharedCenter) {
+        return innerCircle->radius > 0 && outerCircle->radius > 0;
+    }
+
+    // 两个点集连续存入工作区，内圆在前
+    const int nInner = static_cast<int>(inner.size());
+    const int n = nInner + static_cast<int>(outer.size());
+    if (static_cast<int>(x_.size()) < n) {
+        x_.resize(n);
+        y_.resize(n);
+    }
+    for (int i = 0; i < nInner; ++i) {
+        x_[i] = inner[i].x;
+        y_[i] = inner[i].y;
+    }
+    for (int i = nInner; i < n; ++i) {
+        x_[i] = outer[i - nInner].x;
+        y_[i] = outer[i - nInner].y;
+    }
+    if (weight == Huber) {
+        refineConcentric<HuberPolicy>(x_.data(), y_.data(), nInner, n, config, innerCircle, outerCircle);
+    }
+    else {
+        refineConcentric<TukeyPolicy>(x_.data(), y_.data(), nInner, n, config, innerCircle, outerCircle);
+    }
+    return innerCircle->radius > 0 && outerCircle->radius > 0;
+}
+
+template <typename WeightPolicy>
+void IrlsCircleSolver::refineConcentric(const double* x, const double* y, int nInner, int n, const FitConfig& config,
+    Circle* innerCircle, Circle* outerCircle)
+{
+    if (static_cast<int>(residuals_.size()) < n) {
+        residuals_.resize(n);
+        scratch_.resize(n);
+    }
+    double* residuals = residuals_.data();
+    double* scratch = scratch_.data();
+    // 初值：圆心按点数加权平均，半径取各自拟合结果
+    const int nOuter = n - nInner;
+    Eigen::Vector4d p;
+    p(0) = (innerCircle->center_x * nInner + outerCircle->center_x * nOuter) / n;
+    p(1) = (innerCircle->center_y * nInner + outerCircle->center_y * nOuter) / n;
+    p(2) = innerCircle->radius;
+    p(3) = outerCircle->radius;
+
+    auto residualAt = [&](const Eigen::Vector4d& q, int i) {
+        double dx = x[i] - q(0);
+        double dy = y[i] - q(1);
+        return std::sqrt(dx * dx + dy * dy) - (i < nInner ? q(2) : q(3));
+    };
+
+    // 鲁棒尺度由初值残差的四分位距估计，迭代中保持不变
+    for (int i = 0; i < n; ++i) {
+        scratch[i] = std::abs(residualAt(p, i));
+    }
+    double q3 = selectNth(scratch, n, 3 * n / 4);
+    double q1 = selectNth(scratch, 3 * n / 4, n / 4);
+    double iqr = q3 - q1;
+    const double k = 3.0 * config.k_factor * ((iqr > 1e-6) ? iqr / 1.349 : 1.0);
+
+    double cost = 0.0;
+    for (int i = 0; i < n; ++i) {
+        residuals[i] = residualAt(p, i);
+        scratch[i] = WeightPolicy::weight(residuals[i], k);
+        cost += scratch[i] * residuals[i] * residuals[i];
+    }
+
+    double lambda = 1e-3;
+    int iter = 0;
+    bool converged = false;
+    for (iter = 0; iter < config.max_iterations; ++iter) {
+        Eigen::Matrix4d jtj = Eigen::Matrix4d::Zero();
+        Eigen::Vector4d jtr = Eigen::Vector4d::Zero();
+        for (int i = 0; i < n; ++i) {
+            double w = scratch[i];
+            double dx = x[i] - p(0);
+            double dy = y[i] - p(1);
+            double d = std::sqrt(dx * dx + dy * dy);
+            if (w <= 0.0 || d < 1e-12) {
+                continue;
+            }
+            Eigen::Vector4d j(-dx / d, -dy / d, i < nInner ? -1.0 : 0.0, i < nInner ? 0.0 : -1.0);
+            jtj.noalias() += w * j * j.transpose();
+            jtr.noalias() += w * residuals[i] * j;
+        }
+        bool accepted = false;
+        double step = 0.0;
+        while (lambda < 1e10) {
+            Eigen::Matrix4d a = jtj;
+            a.diagonal() *= (1.0 + lambda);
+            Eigen::Vector4d delta = a.ldlt().solve(-jtr);
+            if (!delta.allFinite()) {
+                lambda *= 10.0;
+                continue;
+            }
+            Eigen::Vector4d trialP = p + delta;
+            double trial = 0.0;
+            for (int i = 0; i < n; ++i) {
+                double res = residualAt(trialP, i);
+                trial += scratch[i] * res * res;
+            }
+            if (trial <= cost && trialP(2) > 0 && trialP(3) > 0) {
+                p = trialP;
+                step = delta.cwiseAbs().maxCoeff();
+                lambda = std::max(lambda * 0.1, 1e-9);
+                accepted = true;
+                break;
+            }
+            lambda *= 10.0;
+        }
+        cost = 0.0;
+        for (int i = 0; i < n; ++i) {
+            residuals[i] = residualAt(p, i);
+            scratch[i] = WeightPolicy::weight(residuals[i], k);
+            cost += scratch[i] * residuals[i] * residuals[i];
+        }
+        if (!accepted || step < config.tolerance) {
+            converged = true;
+            ++iter;
+            break;
+        }
+    }
+
+    // 分别统计两圆的加权RMS
+    double sums[2] = { 0.0, 0.0 }, weights[2] = { 0.0, 0.0 };
+    for (int i = 0; i < n; ++i) {
+        int c = i < nInner ? 0 : 1;
+        sums[c] += scratch[i] * residuals[i] * residuals[i];
+        weights[c] += scratch[i];
+    }
+    const std::string method = std::string("Concentric_LM_(") + WeightPolicy::name() + ")";
+    *innerCircle = Circle(p(0), p(1), p(2), weights[0] > 0 ? std::sqrt(sums[0] / weights[0]) : 0.0, iter, method, converged);
+    *outerCircle = Circle(p(0), p(1), p(3), weights[1] > 0 ? std::sqrt(sums[1] / weights[1]) : 0.0, iter, method, converged);
+}
@@ -0,0 +1,85 @@
+#ifndef IRLS_CIRCLE_SOLVER_H
+#define IRLS_CIRCLE_SOLVER_H
+#include <vector>
+#include "define.h"
+
+
+/*
+    IRLS圆拟合求解器 ---- 与fitCircleIRLSOptimized迭代策略一致（中位数初值、IQR尺度、自适应k、阻尼更新）
+    1. 每次迭代只累加加权3x3法方程（坐标先平移到均值附近保证数值稳定），固定尺寸Eigen求解
+    2. 中位数/四分位数使用nth_element线性选择，不做完整排序
+    3. 权重函数在编译期特化，工作区在多次调用之间复用，稳态下不分配内存
+    非线程安全：每个线程/算法实例持有自己的求解器
+*/
+class IrlsCircleSolver
+{
+public:
+    enum WeightType { Tukey, Huber };
+
+    IrlsCircleSolver() = default;
+
+    // 拟合点集（x, y为连续存储的坐标）
+    Circle fit(const double* x, const double* y, int n, const FitConfig& config, WeightType weight);
+    Circle fit(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight);
+    // 热启动拟合：以seed（如上一帧结果）为初值，参数变化低于tolerance即提前结束
+    Circle fitWarm(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight, const Circle& seed);
+
+    // 一致性预筛选 + IRLS：随机抽取3点生成圆假设，按内点数评分，
+    // 以最优假设的内点集和圆作为IRLS的输入与初值（适用于毛刺、select=all等离群点较多的情况）
+    // inlierThreshold为内点的几何距离阈值（像素），maxHypotheses为最大假设数
+    // geometric为true时内点集改用几何LM精修
+    Circle fitConsensus(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight,
+        double inlierThreshold, int maxHypotheses = 500, bool geometric = false);
+
+    // 几何距离拟合：一次代数解（或seed）作为初值，鲁棒Levenberg-Marquardt最小化 sum w*(|p - c| - r)^2
+    // 解析雅可比、3x3固定尺寸求解，通常3~6次迭代收敛；填写iterations、error（加权RMS）、IsConverged
+    Circle fitGeometric(const std::vector<Pointf>& points, const FitConfig& config, WeightType weight, const Circle* seed = nullptr);
+
+    // 同心双圆拟合：inner/outer各自IRLS拟合作为初值；sharedCenter为true时再用鲁棒LM联合求解
+    // (cx, cy, r_inner, r_outer)，两圆共用圆心。任一点集不足3点时返回false
+    bool fitConcentric(const std::vector<Pointf>& inner, const std::vector<Pointf>& outer, const FitConfig& config,
+        WeightType weight, bool sharedCenter, Circle* innerCircle, Circle* outerCircle);
+
+    // 批量拟合：offsets为count+1项的偏移表，第i个圆的点为x/y[offsets[i], offsets[i+1])
+    // 按块分配到threads个工作线程（每个线程独立求解器），结果写入out[0, count)
+    static void fitBatch(const int* offsets, int count, const double* x, const double* y,
+        const FitConfig& config, WeightType weight, int threads, Circle* out);
+
+    // 拟合不确定度：3倍鲁棒尺度以内的点按几何残差估计协方差 sigma^2 * (J^T J)^-1，
+    // 返回圆心x/y、半径三者标准差的最大值（像素）；点数不足或退化时返回无穷大
+    static double estimateUncertainty(const std::vector<Pointf>& points, const Circle& circle);
+
+    // 简单线性最小二乘（代数距离）拟合，error为几何RMSE
+    static Circle fitSimpleLS(const std::vector<Pointf>& points);
+
+    // 由FitConfig::weight_type解析权重类型
+    static WeightType weightTypeFromString(const std::string& name);
+
+private:
+    template <typename WeightPolicy>
+    Circle fitImpl(const double* x, const double* y, int n, const FitConfig& config, const Circle* seed);
+    template <typename WeightPolicy>
+    Circle refineGeometric(const double* x, const double* y, int n, const FitConfig& config, const Circle& init);
+    Circle refineGeometric(const double* x, const double* y, int n, const FitConfig& config, WeightType weight, const Circle* seed);
+    // 共用圆心的双圆LM：前nInner个点属于内圆，其余属于外圆
+    template <typename WeightPolicy>
+    void refineConcentric(const double* x, const double* y, int nInner, int n, const FitConfig& config,
+        Circle* innerCircle, Circle* outerCircle);
+    // 单次代数（Kasa）拟合，坐标平移到均值附近求解
+    static bool algebraicFit(const double* x, const double* y, int n, Circle* circle);
+    // 拷贝点坐标到工作区
+    void loadPoints(const std::vector<Pointf>& points);
+    // 一致性搜索，返回最优假设的内点数（不足3个时返回0）
+    int findConsensus(const double* x, const double* y, int n, double inlierThreshold, int maxHypotheses, Circle* best);
+
+private:
+    // 复用的工作区
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> residuals_;
+    std::vector<double> scratch_;
+    std::vector<double> inlierX_;
+    std::vector<double> inlierY_;
+};
+
+#endif // IRLS_CIRCLE_SOLVER_H
@@ -30,10 +30,20 @@ ShapeBasedMatching::ShapeBasedMatching() : nextTemplateId_(1), numThreads_(1) {
 
 ShapeBasedMatching::~ShapeBasedMatching()
 {
-	// ģ
+	// ȴ̨ؽģ
+	waitForPendingRebuilds();
 	clearAllTemplates();
 }
 
+ShapeBasedMatching::ShapeModelHandle::~ShapeModelHandle()
+{
+	try {
+		ClearShapeModel(modelId);
+	} catch (HException& ex) {
+		cerr << "Error clearing shape model: " << ex.ErrorMessage().Text() << endl;
+	}
+}
+
 // ========================= ģ崴ʵ ===================== //
 
 int ShapeBasedMatching::createTemplate(const HalconCpp::HObject& image, const HalconCpp::HObject& region, const std::string& templateName)
@@ -53,66 +63,33 @@ int ShapeBasedMatching::createTemplate(const HalconCpp::HObject& image, const Ha
 
 int ShapeBasedMatching::createTemplateAdvanced(const HalconCpp::HObject& image, const HalconCpp::HObject& region, const TemplateConfig& config)
 {
-	// ʹû
-	lock_guard<mutex> lock(templatesMutex_);
 	try {
 		// Ч
 		if (region.CountObj() == 0) {
 			cerr << "Error: Region is empty" << endl;
 			return -1;
 		}
-		// ȡͼߴ֤
-		HTuple width, height;
-		GetImageSize(image, &width, &height);
-		// ״ģ
+		// ԳģֻһԳ
+		TemplateConfig effectiveConfig = applySymmetryReduction(image, region, config);
+		// ģͺʱϳУģƥ
 		HTuple modelId;
-		// Ƿֳ֧߶ȲѡͬĴ
-		if (config.isScaleInvariant && config.minScale > 0 && config.maxScale > 0) {
-			// ֳ֧߶ȲԵģ
-			CreateScaledShapeModel(
-				image,							// ģͼ
-				config.numLevels,				// 
-				config.angleStart,				// ʼǶ
-				config.angleExtent,				// ǶȷΧ
-				config.angleStep,				// ǶȲ
-				config.minScale,				// С
-				config.maxScale,				// 
-				config.angleStep,				// ŲʹýǶȲ
-				config.optimization.c_str(),	// Ż
-				config.metric.c_str(),			// 
-				config.contrast,				// Աȶ
-				config.minContrast,				// СԱȶ
-				&modelId						// ģID
-			);
-		} else {
-			// ͳ״ƥ
-			CreateShapeModel(
-				image,							// ģͼ
-				config.numLevels,				// 
-				config.angleStart,				// ʼǶ
-				config.angleExtent,				// ǶȷΧ
-				config.angleStep,				// ǶȲ
-				config.optimization.c_str(),	// Ż
-				config.metric.c_str(),			// 
-				config.contrast,				// Աȶ
-				config.minContrast,				// СԱȶ
-				&modelId						// ģID
-			);
-		}
-		// ģԭ
-		HTuple area, row, col;
-		AreaCenter(region, &area, &row, &col);
-		if (area.Length() > 0 && area[0].D() > 0) {
-			SetShapeModelOrigin(modelId, row[0], col[0]);
-		}
-		// ȡģ
 		HObject contour;
-		GetShapeModelContours(&contour, modelId, 1);
+		buildShapeModel(image, region, effectiveConfig, modelId, contour);
+		// ʹû
+		lock_guard<mutex> lock(templatesMutex_);
 		// ģϢ
 		int newId = getNextTemplateId();
-		TemplateInfoPtr info = make_shared<TemplateInfo>(newId, config);
-		/*info->modelId = modelId;*/
+		TemplateInfoPtr info = make_shared<TemplateInfo>(
+			newId, config.tmpName, modelId, effectiveConfig.angleStart, effectiveConfig.angleExtent);
+		info->modelHandle = make_shared<ShapeModelHandle>(modelId);
 		info->contour = contour;
+		info->modelImage = image;
+		info->modelRegion = region;
+		// ûԭʼãؽʱ¼Գ
+		info->config = config;
+		info->angleStep = effectiveConfig.angleStep;
+		info->modelRadius = computeModelRadius(contour);
+		info->symmetryOrder = effectiveConfig.symmetryOrder;
 		// ģ
 		templates_[newId] = info;
 		cout << "Template created successfully: ID=" << newId
@@ -124,6 +101,54 @@ int ShapeBasedMatching::createTemplateAdvanced(const HalconCpp::HObject& image,
 	}
 }
 
+void ShapeBasedMatching::buildShapeModel(const HalconCpp::HObject& image, const HalconCpp::HObject& region, const TemplateConfig& config, HalconCpp::HTuple& modelId, HalconCpp::HObject& contour) const
+{
+	// ȡͼߴ֤
+	HTuple width, height;
+	GetImageSize(image, &width, &height);
+	// Ƿֳ֧߶ȲѡͬĴ
+	if (config.isScaleInvariant && config.minScale > 0 && config.maxScale > 0) {
+		// ֳ֧߶ȲԵģ
+		CreateScaledShapeModel(
+			image,							// ģͼ
+			config.numLevels,				// 
+			config.angleStart,				// ʼǶ
+			config.angleExtent,				// ǶȷΧ
+			config.angleStep,				// ǶȲ
+			config.minScale,				// С
+			config.maxScale,				// 
+			config.angleStep,				// ŲʹýǶȲ
+			config.optimization.c_str(),	// Ż
+			config.metric.c_str(),			// 
+			config.contrast,				// Աȶ
+			config.minContrast,				// СԱȶ
+			&modelId						// ģID
+		);
+	} else {
+		// ͳ״ƥ
+		CreateShapeModel(
+			image,							// ģͼ
+			config.numLevels,				// 
+			config.angleStart,				// ʼǶ
+			config.angleExtent,				// ǶȷΧ
+			config.angleStep,				// ǶȲ
+			config.optimization.c_str(),	// Ż
+			config.metric.c_str(),			// 
+			config.contrast,				// Աȶ
+			config.minContrast,				// СԱȶ
+			&modelId						// ģID
+		);
+	}
+	// ģԭ
+	HTuple area, row, col;
+	AreaCenter(region, &area, &row, &col);
+	if (area.Length() > 0 && area[0].D() > 0) {
+		SetShapeModelOrigin(modelId, row[0], col[0]);
+	}
+	// ȡģ
+	GetShapeModelContours(&contour, modelId, 1);
+}
+
 std::vector<int> ShapeBasedMatching::createTemplatesBatch(const std::vector<HalconCpp::HObject>& images, const std::vector<HalconCpp::HObject>& regions, const std::vector<std::string>& names, const TemplateConfig& commonConfig)
 {
 	std::vector<int> createdIds;
@@ -274,7 +299,7 @@ bool ShapeBasedMatching::findTemplateAdvanced(const HalconCpp::HObject& image, i
 	}
 }
 
-bool ShapeBasedMatching::findMultipleTemplatesOptimized(const HalconCpp::HObject& image, const std::vector<int>& templateIds, std::vector<MatchingResult>& results, double minScore, int maxMatchesPerTemplate, double greediness, bool usePyramid, bool useCache, int numThreads)
+bool ShapeBasedMatching::findMultipleTemplatesOptimized(const HalconCpp::HObject& image, const std::vector<int>& templateIds, std::vector<MatchingResult>& results, double minScore, int maxMatchesPerTemplate, double greediness, bool usePyramid, bool useCache, int numThreads, bool twoPhase)
 {
 	results.clear();
 	try {
@@ -296,53 +321,49 @@ bool ShapeBasedMatching::findMultipleTemplatesOptimized(const HalconCpp::HObject
 			cerr << "Warning: No templates to search" << endl;
 			return false;
 		}
-		// ߳ƥ
-		if (numThreads > 1 && idsToSearch.size() > 1) {
-			// ƥ - ʹstd::async
-			vector<future<vector<MatchingResult>>> futures;
-			vector<MatchingResult> allResults;
-			// 첽
-			for (int templateId : idsToSearch) {
-				futures.push_back(async(launch::async, [&, templateId]() {
-					vector<MatchingResult> localResults;
-					findTemplateAdvanced(
-						processedImage, templateId, localResults,
-						minScore, maxMatchesPerTemplate, greediness,
-						"least_squares", 0, 0.5, true
-					);
-					return localResults;
-					}));
-			}
-			// ռ
-			for (size_t i = 0; i < futures.size(); i++) {
-				auto templateResults = futures[i].get();
-				allResults.insert(allResults.end(),
-					templateResults.begin(),
-					templateResults.end());
-			}
-			results = allResults;
-		} else {
-			// ˳ƥ
-			for (int templateId : idsToSearch) {
-				vector<MatchingResult> templateResults;
-				if (findTemplateAdvanced(processedImage, templateId, templateResults,
-					minScore, maxMatchesPerTemplate, greediness,
-					"least_squares", 0, 0.5, true)) {
-					results.insert(results.end(),
-						templateResults.begin(),
-						templateResults.end());
-				}
-			}
+		// ׶ģʽ´أλֻձĽ
+		const HTuple searchSubPixel = twoPhase ? HTuple("none") : HTuple("least_squares");
+		const bool searchIsSubpixel = !twoPhase;
+		// ƥ - ߳numThreads
+		// ģֻԼɲִ
+		vector<vector<MatchingResult>> perTemplateResults(idsToSearch.size());
+		parallelFor(idsToSearch.size(), numThreads, [&](size_t i) {
+			findTemplateAdvanced(
+				processedImage, idsToSearch[i], perTemplateResults[i],
+				minScore, maxMatchesPerTemplate, greediness,
+				searchSubPixel, 0, 0.5, searchIsSubpixel
+			);
+			});
+		// ģ˳ռ֤˳ȷ
+		for (size_t i = 0; i < perTemplateResults.size(); i++) {
+			results.insert(results.end(),
+				perTemplateResults[i].begin(),
+				perTemplateResults[i].end());
 		}
 		// 
 		sort(results.begin(), results.end(), [](const MatchingResult& a, const MatchingResult& b) {
 			return a.score > b.score;
 			});
+		// ׶ģʽͬģͬһĿʱֻ
+		if (twoPhase) {
+			suppressOverlappingResults(results, 0.5);
+		}
 		// ƥ ֹ
 		size_t maxTotalMatches = maxMatchesPerTemplate * idsToSearch.size();
 		if (results.size() > maxTotalMatches) {
 			results.resize(maxTotalMatches);
 		}
+		// ׶ģʽԱĽ߾Ⱦλ
+		if (twoPhase && !results.empty()) {
+			const HTuple refineSubPixel("least_squares_high");
+			parallelFor(results.size(), numThreads, [&](size_t i) {
+				refineMatchResult(processedImage, results[i], refineSubPixel);
+				});
+			// λܱ仯
+			sort(results.begin(), results.end(), [](const MatchingResult& a, const MatchingResult& b) {
+				return a.score > b.score;
+				});
+		}
 		return !results.empty();
 	} catch (HException& ex) {
 		cerr << "Error in optimized multiple template matching: "
@@ -351,6 +372,30 @@ bool ShapeBasedMatching::findMultipleTemplatesOptimized(const HalconCpp::HObject
 	}
 }
 
+void ShapeBasedMatching::parallelFor(size_t count, int numThreads, const std::function<void(size_t)>& body)
+{
+	size_t numWorkers = numThreads > 1 ? min(static_cast<size_t>(numThreads), count) : 1;
+	if (numWorkers <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			body(i);
+		}
+		return;
+	}
+	// ̹߳±߳޹
+	atomic<size_t> nextIndex(0);
+	vector<future<void>> futures;
+	for (size_t w = 0; w < numWorkers; w++) {
+		futures.push_back(async(launch::async, [&]() {
+			for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+				body(i);
+			}
+			}));
+	}
+	for (size_t w = 0; w < futures.size(); w++) {
+		futures[w].get();
+	}
+}
+
 bool ShapeBasedMatching::findAllTemplates(const HalconCpp::HObject& image, std::vector<MatchingResult>& results, double minScore, int maxMatchesPerTemplate, bool useParallel)
 {
 	return findMultipleTemplatesOptimized(
@@ -387,33 +432,24 @@ bool ShapeBasedMatching::getTemplateConfig(int templateId, TemplateConfig& confi
 		return false;
 	}
 	try {
-		// HalconģͻȡϢ
-		HTuple angleStart, angleExtent, angleStep, optimization, metric;
-		HTuple contrast, minContrast, minScale, maxScale;
-		GetShapeModelParams(templateInfo->modelId, &angleStart, &angleExtent,
-			&angleStep, &optimization, &metric, &contrast,
-			&minContrast, &minScale, &maxScale);
+		// Դ/ؽʱΪ׼optimizationcontrastautoSymmetryHalconģͲ¼
+		config = templateInfo->config;
 		config.tmpName = templateInfo->name;
-		config.angleStart = angleStart.D();
-		config.angleExtent = angleExtent.D();
+		// ʵЧĽǶȷΧԳС
+		config.angleStart = templateInfo->angleStart;
+		config.angleExtent = templateInfo->angleExtent;
+		config.symmetryOrder = templateInfo->symmetryOrder;
+		config.modelId = templateInfo->modelId;
+		// ŷΧģͶȡļصģֻģͿ
+		// ˳: NumLevels, AngleStart, AngleExtent, AngleStep, ScaleMin, ScaleMax, ScaleStep, Metric, MinContrast
+		HTuple numLevels, angleStart, angleExtent, angleStep, minScale, maxScale, scaleStep, metric, minContrast;
+		GetShapeModelParams(templateInfo->modelId, &numLevels, &angleStart, &angleExtent,
+			&angleStep, &minScale, &maxScale, &scaleStep, &metric, &minContrast);
 		config.angleStep = angleStep.D();
-		config.optimization = optimization.S();
 		config.metric = metric.S();
-		config.contrast = contrast.I();
 		config.minContrast = minContrast.I();
-		config.modelId = templateInfo->modelId;
-		// Ƿ߶Ȳģ
-		try {
-			// ԻȡŲʧ˵ǳ߶Ȳģ
-			HTuple scale;
-			GetShapeModelParams(templateInfo->modelId, &HTuple(), &HTuple(),
-				&HTuple(), &HTuple(), &HTuple(), &HTuple(),
-				&HTuple(), &minScale, &maxScale);
-			config.isScaleInvariant = true;
-			config.minScale = minScale.D();
-			config.maxScale = maxScale.D();
-		} catch (...) {
-			config.isScaleInvariant = false;
+		config.isScaleInvariant = minScale.D() < maxScale.D();
+		if (config.isScaleInvariant) {
 			config.minScale = minScale.D();
 			config.maxScale = maxScale.D();
 		}
@@ -426,28 +462,123 @@ bool ShapeBasedMatching::getTemplateConfig(int templateId, TemplateConfig& confi
 
 bool ShapeBasedMatching::updateTemplateConfig(int templatedId, const TemplateConfig& newConfig)
 {
-	TemplateInfoPtr templateInfo = findTemplateInfo(templatedId);
-	if (!templateInfo) {
+	TemplateInfoPtr templateInfo;
+	{
+		// ЧдʱƣڽеӰ죩
+		lock_guard<mutex> lock(templatesMutex_);
+		TemplateMap::iterator it = templates_.find(templatedId);
+		if (it == templates_.end()) {
+			return false;
+		}
+		templateInfo = make_shared<TemplateInfo>(*it->second);
+		templateInfo->name = newConfig.tmpName;
+		templateInfo->config.tmpName = newConfig.tmpName;
+		it->second = templateInfo;
+	}
+	if (!configRequiresRebuild(templateInfo->config, newConfig)) {
+		return true;
+	}
+	if (!templateInfo->modelImage.IsInitialized() || templateInfo->modelImage.CountObj() == 0) {
+		// ļصģûԭʼͼ޷ؽ
+		cerr << "Warning: Template has no source image, model parameters cannot be rebuilt. ID="
+			<< templatedId << endl;
 		return false;
 	}
+	// ں̨ؽģͣģ滻ǰṩƥ
+	lock_guard<mutex> lock(rebuildMutex_);
+	int generation = ++rebuildGeneration_[templatedId];
+	// ɵؽ
+	rebuildTasks_.erase(remove_if(rebuildTasks_.begin(), rebuildTasks_.end(),
+		[](future<void>& task) {
+			return task.wait_for(chrono::seconds(0)) == future_status::ready;
+		}), rebuildTasks_.end());
+	HObject image = templateInfo->modelImage;
+	HObject region = templateInfo->modelRegion;
+	rebuildTasks_.push_back(async(launch::async, [this, templatedId, generation, image, region, newConfig]() {
+		rebuildTemplate(templatedId, generation, image, region, newConfig);
+		}));
+	return true;
+}
+
+void ShapeBasedMatching::waitForPendingRebuilds()
+{
+	vector<future<void>> tasks;
+	{
+		lock_guard<mutex> lock(rebuildMutex_);
+		tasks.swap(rebuildTasks_);
+	}
+	for (size_t i = 0; i < tasks.size(); i++) {
+		tasks[i].wait();
+	}
+}
+
+void ShapeBasedMatching::rebuildTemplate(int templateId, int generation, const HalconCpp::HObject& image, const HalconCpp::HObject& region, const TemplateConfig& config)
+{
 	try {
-		// ģ
-		templateInfo->name = newConfig.tmpName;
-		// ע⣺HalconģͲڴֱ֮޸
-		// Ҫ޸ĲҪ´ģ
-		cerr << "Warning: Halcon model parameters cannot be modified after creation.";
-		return true;
+		TemplateConfig effectiveConfig = applySymmetryReduction(image, region, config);
+		HTuple modelId;
+		HObject contour;
+		buildShapeModel(image, region, effectiveConfig, modelId, contour);
+		// ģɳ߹δ滻ʱһͷ
+		ShapeModelHandlePtr handle = make_shared<ShapeModelHandle>(modelId);
+		double modelRadius = computeModelRadius(contour);
+
+		lock_guard<mutex> lock(templatesMutex_);
+		TemplateMap::iterator it = templates_.find(templateId);
+		if (it == templates_.end()) {
+			// ؽڼģѱ
+			return;
+		}
+		{
+			lock_guard<mutex> rebuildLock(rebuildMutex_);
+			if (rebuildGeneration_[templateId] != generation) {
+				// иµؽ󣬶ν
+				return;
+			}
+		}
+		// ԭ滻еľģϢͷţģ֮
+		TemplateInfoPtr info = make_shared<TemplateInfo>(*it->second);
+		info->modelId = modelId;
+		info->modelHandle = handle;
+		info->contour = contour;
+		info->config = config;
+		info->config.tmpName = info->name;
+		info->angleStart = effectiveConfig.angleStart;
+		info->angleExtent = effectiveConfig.angleExtent;
+		info->angleStep = effectiveConfig.angleStep;
+		info->modelRadius = modelRadius;
+		info->symmetryOrder = effectiveConfig.symmetryOrder;
+		it->second = info;
+		cout << "Template rebuilt successfully: ID=" << templateId << endl;
 	} catch (HException& ex) {
-		return false;
+		cerr << "Error rebuilding template " << templateId << ": "
+			<< ex.ErrorMessage().Text() << endl;
 	}
 }
 
+bool ShapeBasedMatching::configRequiresRebuild(const TemplateConfig& current, const TemplateConfig& target)
+{
+	return current.numLevels != target.numLevels ||
+		fabs(current.angleStart - target.angleStart) > 1e-9 ||
+		fabs(current.angleExtent - target.angleExtent) > 1e-9 ||
+		fabs(current.angleStep - target.angleStep) > 1e-9 ||
+		current.optimization != target.optimization ||
+		current.metric != target.metric ||
+		current.contrast != target.contrast ||
+		current.minContrast != target.minContrast ||
+		current.isScaleInvariant != target.isScaleInvariant ||
+		current.autoSymmetry != target.autoSymmetry ||
+		(target.isScaleInvariant &&
+			(fabs(current.minScale - target.minScale) > 1e-9 ||
+			 fabs(current.maxScale - target.maxScale) > 1e-9));
+}
+
 bool ShapeBasedMatching::clearTemplate(int templateId)
 {
 	lock_guard<mutex> lock(templatesMutex_);
 	TemplateMap::iterator it = templates_.find(templateId);
 	if (it != templates_.end()) {
-		ClearShapeModel(it->second->modelId);
+		// ģһʹɾ
 		templates_.erase(it);
 		cout << "Template cleared: ID= " << templateId << endl;
 		return true;
@@ -458,9 +589,8 @@ bool ShapeBasedMatching::clearTemplate(int templateId)
 void ShapeBasedMatching::clearAllTemplates()
 {
 	lock_guard<mutex> lock(templatesMutex_);
-	// ͨѭķʽʵ
-	for (TemplateMap::iterator it = templates_.begin(); it != templates_.end(); ++it) {
-		ClearShapeModel(it->second->modelId);
+	// ģɾ
+	if (!templates_.empty()) {
 		templates_.clear();
 		cout << "All templates cleared" << endl;
 	}
@@ -489,6 +619,58 @@ std::string ShapeBasedMatching::getTemplateName(int templateId) const
 	return "";
 }
 
+bool ShapeBasedMatching::setTemplateSearchRegion(int templateId, const HalconCpp::HObject& region, double angleStart, double angleExtent)
+{
+	lock_guard<mutex> lock(templatesMutex_);
+	TemplateMap::iterator it = templates_.find(templateId);
+	if (it == templates_.end()) {
+		return false;
+	}
+	try {
+		HObject searchRegion;
+		Union1(region, &searchRegion);
+		// дʱƣڽеʹþɵģϢ
+		TemplateInfoPtr info = make_shared<TemplateInfo>(*it->second);
+		info->hasSearchRegion = true;
+		info->searchRegion = searchRegion;
+		info->searchAngleStart = angleStart;
+		info->searchAngleExtent = angleExtent;
+		it->second = info;
+		return true;
+	} catch (HException& ex) {
+		cerr << "Error setting search region: " << ex.ErrorMessage().Text() << endl;
+		return false;
+	}
+}
+
+bool ShapeBasedMatching::getTemplateSearchRegion(int templateId, HalconCpp::HObject& region, double& angleStart, double& angleExtent) const
+{
+	TemplateInfoPtr templateInfo = findTemplateInfo(templateId);
+	if (!templateInfo || !templateInfo->hasSearchRegion) {
+		return false;
+	}
+	region = templateInfo->searchRegion;
+	angleStart = templateInfo->searchAngleStart;
+	angleExtent = templateInfo->searchAngleExtent;
+	return true;
+}
+
+bool ShapeBasedMatching::clearTemplateSearchRegion(int templateId)
+{
+	lock_guard<mutex> lock(templatesMutex_);
+	TemplateMap::iterator it = templates_.find(templateId);
+	if (it == templates_.end()) {
+		return false;
+	}
+	TemplateInfoPtr info = make_shared<TemplateInfo>(*it->second);
+	info->hasSearchRegion = false;
+	info->searchRegion = HObject();
+	info->searchAngleStart = 0.0;
+	info->searchAngleExtent = 0.0;
+	it->second = info;
+	return true;
+}
+
 // ============================ ģ־ûʵ ================================== //
 
 bool ShapeBasedMatching::saveTemplate(int templateId, const std::string& filePath) const
@@ -499,6 +681,7 @@ bool ShapeBasedMatching::saveTemplate(int templateId, const std::string& filePat
 	}
 	try {
 		WriteShapeModel(templateInfo->modelId, HTuple(filePath.c_str()));
+		writeSearchRegion(*templateInfo, filePath);
 		cout << "Template saved: ID=" << templateId << ", Path=" << filePath << endl;
 		return true;
 	} catch (HException& ex) {
@@ -513,16 +696,26 @@ int ShapeBasedMatching::loadTemplate(const std::string& filePath, const std::str
 		HTuple modelId;
 		ReadShapeModel(HTuple(filePath.c_str()), &modelId);
 		// ȡģĽǶȲ
-		HTuple numLevel, numLevel, angleStart, angleExtent;
-		GetShapeModelParams(modelId, &numLevel, &angleStart, &angleExtent, 
-			&HTuple(), &HTuple(), &HTuple(), &HTuple(), &HTuple(), &HTuple());
+		HTuple numLevel, angleStart, angleExtent, angleStep;
+		HTuple minScale, maxScale, scaleStep, metric, minContrast;
+		GetShapeModelParams(modelId, &numLevel, &angleStart, &angleExtent,
+			&angleStep, &minScale, &maxScale, &scaleStep, &metric, &minContrast);
 		// ģϢ
 		lock_guard<mutex> lock(templatesMutex_);
 		int newId = getNextTemplateId();
 		TemplateInfoPtr info = make_shared<TemplateInfo>(
 			newId, templateName, modelId, angleStart.D(), angleExtent.D());
+		info->modelHandle = make_shared<ShapeModelHandle>(modelId);
+		info->config.tmpName = templateName;
+		info->config.angleStart = angleStart.D();
+		info->config.angleExtent = angleExtent.D();
+		info->config.angleStep = angleStep.D();
+		info->angleStep = angleStep.D();
 		// ȡ
 		GetShapeModelContours(&(info->contour), modelId, 1);
+		info->modelRadius = computeModelRadius(info->contour);
+		// ȡģ屣ڣ
+		readSearchRegion(*info, filePath);
 		// ģ
 		templates_[newId] = info;
 		cout << "Template loaded successfully: ID=" << newId <<
@@ -551,6 +744,7 @@ bool ShapeBasedMatching::saveAllTemplates(const std::string& directoryPath) cons
 				+ "_" + to_string(templateId) + ".shm";
 			try {
 				WriteShapeModel(info->modelId, HTuple(filename.c_str()));
+				writeSearchRegion(*info, filename);
 				cout << "Template saved: " << filename << endl;
 			} catch (HException& ex) {
 				cerr << "Error saving template " << templateId << ": "
@@ -616,25 +810,29 @@ bool ShapeBasedMatching::executeHalconMatch(const HalconCpp::HObject& image, con
 {
 	try {
 		HTuple rows, cols, angles, scores, scales;
-		// Ƿǳ߶Ȳģ
-		bool isScaled = false;
-		HTuple minScale, maxScale;
-		// ԻȡŲ
-		GetShapeModelParams(templateInfo.modelId, &HTuple(), &HTuple(),
-			&HTuple(), &HTuple(), &HTuple(), &HTuple(),
-			&HTuple(), &minScale, &maxScale);
-		if (minScale[0].D() != 0 && maxScale[0].D() != 0) {
-			isScaled = true;
+		// ʱֻʱСͼ仯
+		HObject searchImage = image;
+		if (templateInfo.hasSearchRegion) {
+			ReduceDomain(image, templateInfo.searchRegion, &searchImage);
+		}
+		double angleStart = templateInfo.angleStart;
+		double angleExtent = templateInfo.angleExtent;
+		if (templateInfo.hasSearchRegion && templateInfo.searchAngleExtent > 0) {
+			angleStart = templateInfo.searchAngleStart;
+			angleExtent = templateInfo.searchAngleExtent;
 		}
+		// Ƿǳ߶Ȳģ
+		double minScale = 1.0, maxScale = 1.0;
+		bool isScaled = getModelScaleRange(templateInfo.modelId, minScale, maxScale);
 		if (isScaled) {
 			// ߶Ȳƥ
 			FindScaledShapeModel(
-				image,							// ͼ
+				searchImage,					// ͼ
 				templateInfo.modelId,	// ģģID
-				templateInfo.angleStart,
-				templateInfo.angleExtent,
-				minScale[0].D(),
-				maxScale[0].D(),
+				angleStart,
+				angleExtent,
+				minScale,
+				maxScale,
 				minScore,						// С
 				maxMatches,						// ƥ
 				isSubpixel? 0.5:0.0,		    // ѹؾ
@@ -650,10 +848,10 @@ bool ShapeBasedMatching::executeHalconMatch(const HalconCpp::HObject& image, con
 		} else {
 			// ͳ״ƥ
 			FindShapeModel(
-				image,							// ͼ
+				searchImage,					// ͼ
 				templateInfo.modelId,	// ģģID
-				templateInfo.angleStart,
-				templateInfo.angleExtent,
+				angleStart,
+				angleExtent,
 				minScore,						// С
 				maxMatches,						// ƥ
 				isSubpixel? 0.5:0.0,			// ؾ
@@ -677,6 +875,302 @@ bool ShapeBasedMatching::executeHalconMatch(const HalconCpp::HObject& image, con
 	}
 }
 
+void ShapeBasedMatching::suppressOverlappingResults(std::vector<MatchingResult>& results, double maxOverlap) const
+{
+	// ѰУ̰ıѱľĺѡΪͬһĿ
+	vector<MatchingResult> kept;
+	vector<double> keptRadius;
+	kept.reserve(results.size());
+	keptRadius.reserve(results.size());
+	map<int, double> radiusCache;
+	for (const MatchingResult& candidate : results) {
+		map<int, double>::iterator it = radiusCache.find(candidate.templateId);
+		if (it == radiusCache.end()) {
+			TemplateInfoPtr info = findTemplateInfo(candidate.templateId);
+			double radius = info ? info->modelRadius : 0.0;
+			it = radiusCache.insert(make_pair(candidate.templateId, radius)).first;
+		}
+		double radius = it->second * candidate.scale;
+		bool overlapped = false;
+		for (size_t k = 0; k < kept.size(); k++) {
+			double minRadius = min(radius, keptRadius[k]);
+			if (minRadius <= 0) {
+				continue;
+			}
+			double dr = candidate.row - kept[k].row;
+			double dc = candidate.column - kept[k].column;
+			// ľСڽСģ뾶(1 - maxOverlap)ʱΪص
+			double limit = (1.0 - maxOverlap) * minRadius;
+			if (dr * dr + dc * dc < limit * limit) {
+				overlapped = true;
+				break;
+			}
+		}
+		if (!overlapped) {
+			kept.push_back(candidate);
+			keptRadius.push_back(radius);
+		}
+	}
+	results.swap(kept);
+}
+
+bool ShapeBasedMatching::refineMatchResult(const HalconCpp::HObject& image, MatchingResult& result, const HalconCpp::HTuple& subPixel) const
+{
+	TemplateInfoPtr templateInfo = findTemplateInfo(result.templateId);
+	if (!templateInfo) {
+		return false;
+	}
+	try {
+		// λøСģԭֻڴ˷Χ
+		const double domainRadius = 3.0;
+		HObject domain, reducedImage;
+		GenCircle(&domain, result.row, result.column, domainRadius);
+		ReduceDomain(image, domain, &reducedImage);
+		// ǶȸСǶȴ
+		double angleWindow = 2.0 * templateInfo->angleStep;
+		double angleStart = result.angle - angleWindow;
+		double angleExtent = 2.0 * angleWindow;
+		// Сֻʹõײ
+		HTuple numLevels;
+		numLevels.Append(2);
+		numLevels.Append(1);
+		HTuple rows, cols, angles, scores, scales;
+		double minScale = 1.0, maxScale = 1.0;
+		bool isScaled = getModelScaleRange(templateInfo->modelId, minScale, maxScale);
+		// λͷʵſھλжʧ
+		double refineMinScore = result.score * 0.8;
+		if (isScaled) {
+			FindScaledShapeModel(reducedImage, templateInfo->modelId,
+				angleStart, angleExtent,
+				max(minScale, result.scale - 0.02),
+				min(maxScale, result.scale + 0.02),
+				refineMinScore, 1, 0.5, subPixel, numLevels, 0.9,
+				&rows, &cols, &angles, &scales, &scores);
+		} else {
+			FindShapeModel(reducedImage, templateInfo->modelId,
+				angleStart, angleExtent,
+				refineMinScore, 1, 0.5, subPixel, numLevels, 0.9,
+				&rows, &cols, &angles, &scores);
+			scales = HTuple(rows.Length(), 1.0);
+		}
+		if (rows.Length() == 0) {
+			// λʧʱ
+			return false;
+		}
+		vector<MatchingResult> refined;
+		convertHalconResults(rows, cols, angles, scores, scales, *templateInfo, refined);
+		result = refined[0];
+		return true;
+	} catch (HException& ex) {
+		cerr << "Error refining match result: " << ex.ErrorMessage().Text() << endl;
+		return false;
+	}
+}
+
+bool ShapeBasedMatching::getModelScaleRange(const HalconCpp::HTuple& modelId, double& minScale, double& maxScale)
+{
+	// ˳: NumLevels, AngleStart, AngleExtent, AngleStep, ScaleMin, ScaleMax, ScaleStep, Metric, MinContrast
+	HTuple numLevels, angleStart, angleExtent, angleStep, scaleMin, scaleMax, scaleStep, metric, minContrast;
+	GetShapeModelParams(modelId, &numLevels, &angleStart, &angleExtent, &angleStep,
+		&scaleMin, &scaleMax, &scaleStep, &metric, &minContrast);
+	minScale = scaleMin.D();
+	maxScale = scaleMax.D();
+	return minScale < maxScale;
+}
+
+bool ShapeBasedMatching::writeSearchRegion(const TemplateInfo& templateInfo, const std::string& filePath)
+{
+	namespace fs = std::filesystem;
+	string regionFile = filePath + ".region.hobj";
+	string windowFile = filePath + ".region.tup";
+	try {
+		if (!templateInfo.hasSearchRegion) {
+			// δʱɾɵĸļص
+			std::error_code ec;
+			fs::remove(regionFile, ec);
+			fs::remove(windowFile, ec);
+			return true;
+		}
+		WriteRegion(templateInfo.searchRegion, HTuple(regionFile.c_str()));
+		HTuple window;
+		window.Append(templateInfo.searchAngleStart);
+		window.Append(templateInfo.searchAngleExtent);
+		WriteTuple(window, HTuple(windowFile.c_str()));
+		return true;
+	} catch (HException& ex) {
+		cerr << "Error saving search region: " << ex.ErrorMessage().Text() << endl;
+		return false;
+	}
+}
+
+void ShapeBasedMatching::readSearchRegion(TemplateInfo& templateInfo, const std::string& filePath)
+{
+	namespace fs = std::filesystem;
+	string regionFile = filePath + ".region.hobj";
+	string windowFile = filePath + ".region.tup";
+	if (!fs::exists(regionFile)) {
+		return;
+	}
+	try {
+		ReadRegion(&templateInfo.searchRegion, HTuple(regionFile.c_str()));
+		templateInfo.hasSearchRegion = true;
+		if (fs::exists(windowFile)) {
+			HTuple window;
+			ReadTuple(HTuple(windowFile.c_str()), &window);
+			if (window.Length() >= 2) {
+				templateInfo.searchAngleStart = window[0].D();
+				templateInfo.searchAngleExtent = window[1].D();
+			}
+		}
+	} catch (HException& ex) {
+		templateInfo.hasSearchRegion = false;
+		cerr << "Error loading search region: " << ex.ErrorMessage().Text() << endl;
+	}
+}
+
+int ShapeBasedMatching::detectRotationalSymmetry(const HalconCpp::HObject& image, const HalconCpp::HObject& region, int contrast)
+{
+	try {
+		// ʹ뽨ģͬĶԱȶȡģͱԵ
+		HObject reduced, modelImages, modelRegions;
+		ReduceDomain(image, region, &reduced);
+		InspectShapeModel(reduced, &modelImages, &modelRegions, 1, contrast);
+		HTuple rows, cols, area, originRow, originCol;
+		GetRegionPoints(modelRegions, &rows, &cols);
+		AreaCenter(region, &area, &originRow, &originCol);
+		if (rows.Length() < 20 || area.Length() == 0) {
+			return 1;
+		}
+		// ģԭΪĽ (Ƕ, 뾶) ռդ񣬽Ƕȷֱ1
+		const int angleBins = 360;
+		const double minRadius = 3.0;		// ԭĵǶȲɿ
+		double r0 = originRow[0].D();
+		double c0 = originCol[0].D();
+		vector<pair<int, int>> cells;
+		cells.reserve(rows.Length());
+		int radialBins = 0;
+		for (int i = 0; i < rows.Length(); i++) {
+			double dr = r0 - rows[i].D();		// £ȡʹǶʱΪ
+			double dc = cols[i].D() - c0;
+			double radius = sqrt(dr * dr + dc * dc);
+			if (radius < minRadius) {
+				continue;
+			}
+			double theta = atan2(dr, dc);
+			if (theta < 0) {
+				theta += 2.0 * m_PI;
+			}
+			int a = static_cast<int>(theta * angleBins / (2.0 * m_PI)) % angleBins;
+			int r = static_cast<int>(radius + 0.5);
+			cells.push_back(make_pair(a, r));
+			radialBins = max(radialBins, r + 2);
+		}
+		if (cells.size() < 20) {
+			return 1;
+		}
+		vector<unsigned char> grid(static_cast<size_t>(angleBins) * radialBins, 0);
+		for (const auto& cell : cells) {
+			grid[static_cast<size_t>(cell.second) * angleBins + cell.first] = 1;
+		}
+		// תһںռդ1Ӧغ
+		const double minAgreement = 0.9;
+		auto agrees = [&](int order) {
+			int shift = angleBins / order;
+			size_t matched = 0;
+			for (const auto& cell : cells) {
+				bool found = false;
+				for (int da = -1; da <= 1 && !found; da++) {
+					int a = (cell.first + shift + da + angleBins) % angleBins;
+					for (int dr = -1; dr <= 1 && !found; dr++) {
+						int r = cell.second + dr;
+						if (r >= 0 && r < radialBins && grid[static_cast<size_t>(r) * angleBins + a]) {
+							found = true;
+						}
+					}
+				}
+				if (found) {
+					matched++;
+				}
+			}
+			return matched >= minAgreement * cells.size();
+		};
+		// Ӹ߽׵ͽײԣn׶ԳƱȻͬʱף
+		// ҪҲͨСǶ1ݲΪ߽
+		const int maxOrder = 36;
+		vector<int> agreement(maxOrder + 1, -1);	// -1δԣ0ͨ1ͨ
+		auto cachedAgrees = [&](int order) {
+			if (agreement[order] < 0) {
+				agreement[order] = agrees(order) ? 1 : 0;
+			}
+			return agreement[order] == 1;
+		};
+		for (int order = maxOrder; order >= 2; order--) {
+			if (angleBins % order != 0 || !cachedAgrees(order)) {
+				continue;
+			}
+			bool divisorsAgree = true;
+			for (int d = 2; d < order && divisorsAgree; d++) {
+				if (order % d == 0) {
+					divisorsAgree = cachedAgrees(d);
+				}
+			}
+			if (divisorsAgree) {
+				return order;
+			}
+		}
+		return 1;
+	} catch (HException& ex) {
+		cerr << "Error detecting rotational symmetry: " << ex.ErrorMessage().Text() << endl;
+		return 1;
+	}
+}
+
+TemplateConfig ShapeBasedMatching::applySymmetryReduction(const HalconCpp::HObject& image, const HalconCpp::HObject& region, const TemplateConfig& config)
+{
+	TemplateConfig effective = config;
+	effective.symmetryOrder = 1;
+	if (!config.autoSymmetry) {
+		return effective;
+	}
+	int order = detectRotationalSymmetry(image, region, config.contrast);
+	if (order <= 1) {
+		return effective;
+	}
+	effective.symmetryOrder = order;
+	double period = 2.0 * m_PI / order;
+	// ûʼǣֻѽǶȷΧСһڣСһʱС
+	if (config.angleExtent > period) {
+		effective.angleExtent = period;
+	}
+	cout << "Rotational symmetry detected: order=" << order
+		<< ", angle extent=" << effective.angleExtent << endl;
+	return effective;
+}
+
+double ShapeBasedMatching::computeModelRadius(const HalconCpp::HObject& contour)
+{
+	double radius = 0.0;
+	try {
+		HTuple count;
+		CountObj(contour, &count);
+		for (int i = 1; i <= count[0].I(); i++) {
+			HObject single;
+			SelectObj(contour, &single, i);
+			HTuple rows, cols;
+			GetContourXld(single, &rows, &cols);
+			// ģԭ
+			for (int k = 0; k < rows.Length(); k++) {
+				double r = rows[k].D();
+				double c = cols[k].D();
+				radius = max(radius, sqrt(r * r + c * c));
+			}
+		}
+	} catch (HException& ex) {
+		cerr << "Error computing model radius: " << ex.ErrorMessage().Text() << endl;
+	}
+	return radius;
+}
+
 void ShapeBasedMatching::convertHalconResults(const HalconCpp::HTuple& rows, const HalconCpp::HTuple& cols, const HalconCpp::HTuple& angles, const HalconCpp::HTuple& scores, const HalconCpp::HTuple& scales, const TemplateInfo& templateInfo, std::vector<MatchingResult>& results) const
 {
 	results.clear();
@@ -689,6 +1183,11 @@ void ShapeBasedMatching::convertHalconResults(const HalconCpp::HTuple& rows, con
 		result.angle = angles[i].D();
 		result.score = scores[i].D();
 		result.scale = scales.Length() > i ? scales[i].D() : 1.0;
+		// Գģ壺ǶȹһʼǿʼһԳ
+		if (templateInfo.symmetryOrder > 1) {
+			double period = 2.0 * m_PI / templateInfo.symmetryOrder;
+			result.angle -= period * floor((result.angle - templateInfo.angleStart) / period);
+		}
 
 		// 㵥ӦԾҪ
 		if (angles.Length() > 0) {
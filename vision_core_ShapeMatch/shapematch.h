@@ -8,6 +8,8 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <future>
+#include <functional>
 #include "Halconcpp.h"
 #include <cmath>
 
@@ -56,6 +58,8 @@ struct TemplateConfig {
 	double minScale;			// Сű
 	double maxScale;			// ű
 	bool isScaleInvariant;		// Ƿߴ粻
+	bool autoSymmetry;			// ʱתԳԣǶȷΧСһԳ
+	int symmetryOrder;			// ⵽תԳƽ1ʾԳƣΪ
 	HalconCpp::HTuple modelId;	// HalconģId
 		
 	// ĬϹ캯
@@ -71,7 +75,9 @@ struct TemplateConfig {
 		minContrast(5),
 		minScale(0.9),
 		maxScale(1.1),
-		isScaleInvariant(false) { }
+		isScaleInvariant(false),
+		autoSymmetry(false),
+		symmetryOrder(1) { }
 };
 
 class ShapeBasedMatching {
@@ -167,6 +173,8 @@ class ShapeBasedMatching {
 
 		/*
 			@brief: ģƥ䣨Ż汾
+			twoPhaseΪtrueʱشȫƺͽضϺ
+			ձĽleast_squares_highλ
 		*/
 		bool findMultipleTemplatesOptimized(
 			const HalconCpp::HObject& image,
@@ -177,7 +185,8 @@ class ShapeBasedMatching {
 			double greediness = 0.8,
 			bool usePyramid = true,
 			bool useCache = true,
-			int numThreads = 1
+			int numThreads = 1,
+			bool twoPhase = false
 		);
 
 		/*
@@ -208,9 +217,16 @@ class ShapeBasedMatching {
 
 		/*
 			@brief ģ
+			ЧģͲ仯ʱں̨ؽģͣؽڼģͼṩƥ䣬
+			ɺԭ滻ģһʹͷ
 		*/
 		bool updateTemplateConfig(int templatedId, const TemplateConfig& newConfig);
 
+		/*
+			@brief ȴк̨ģؽ
+		*/
+		void waitForPendingRebuilds();
+
 		/*
 			@brief ָģ
 		*/
@@ -236,6 +252,32 @@ class ShapeBasedMatching {
 		*/
 		std::string getTemplateName(int templateId) const;
 
+		/*
+			@brief ģͽǶȴڣ޶ģԭΧ
+			angleExtent <= 0 ʱģ崴ʱĽǶȷΧ
+		*/
+		bool setTemplateSearchRegion(
+			int templateId,
+			const HalconCpp::HObject& region,
+			double angleStart = 0.0,
+			double angleExtent = 0.0
+		);
+
+		/*
+			@brief ȡģδʱfalse
+		*/
+		bool getTemplateSearchRegion(
+			int templateId,
+			HalconCpp::HObject& region,
+			double& angleStart,
+			double& angleExtent
+		) const;
+
+		/*
+			@brief ģ򣬻ָȫͼ
+		*/
+		bool clearTemplateSearchRegion(int templateId);
+
 		// ========================== ģ־û ====================================== //
 		/*
 			@brief ģ嵽ļ
@@ -258,20 +300,41 @@ class ShapeBasedMatching {
 		std::vector<int> loadAllTemplates(const std::string& directoryPath);
 
 	private:
+		// Halconģ;ߣһͷʱģ
+		struct ShapeModelHandle {
+			HalconCpp::HTuple modelId;
+			explicit ShapeModelHandle(const HalconCpp::HTuple& modelId_) : modelId(modelId_) {}
+			~ShapeModelHandle();
+		};
+		typedef std::shared_ptr<ShapeModelHandle> ShapeModelHandlePtr;
+
 		// ģϢṹ ˽в֣
 		struct TemplateInfo {
 			int id;
 			std::string name;
 			HalconCpp::HTuple modelId;
+			ShapeModelHandlePtr modelHandle;	// ģȨģϢи
 			HalconCpp::HObject contour;
+			HalconCpp::HObject modelImage;		// ģͼؽģͣļصģΪգ
+			HalconCpp::HObject modelRegion;		// ģ
+			TemplateConfig config;				// ģʹõ
 			double angleStart;
 			double angleExtent;
+			double angleStep;			// ģǶȲھλĽǶȴ
+			double modelRadius;			// ģӰ뾶ڿģ
+			int symmetryOrder;			// תԳƽؽǶȹһһԳ
+			bool hasSearchRegion;		// Ƿ޶
+			HalconCpp::HObject searchRegion;	// ģԭ
+			double searchAngleStart;	// ӦʼǶ
+			double searchAngleExtent;	// ӦĽǶȷΧ<=0ʾģǶȣ
 
 			TemplateInfo(int id_, const std::string& name_,
 				const HalconCpp::HTuple& modelId_,
 				double angleStart_, double angleExtent_) :
 				id(id_), name(name_), modelId(modelId_),
-				angleStart(angleStart_), angleExtent(angleExtent_) {
+				angleStart(angleStart_), angleExtent(angleExtent_),
+				angleStep(0.0174533), modelRadius(0.0), symmetryOrder(1),
+				hasSearchRegion(false), searchAngleStart(0.0), searchAngleExtent(0.0) {
 			}
 		};
 
@@ -288,12 +351,62 @@ class ShapeBasedMatching {
 		// ̳߳أʵ֣
 		int numThreads_;
 
+		// ̨ģؽͬһģֻһؽĽᱻ滻
+		std::vector<std::future<void>> rebuildTasks_;
+		std::map<int, int> rebuildGeneration_;
+		std::mutex rebuildMutex_;
+
 		// ========================= ˽и ============================== //
 		/*
 			@brief ڲģϢ̰߳ȫ
 		*/
 		TemplateInfoPtr findTemplateInfo(int templateId) const;
 
+		/*
+			@brief ôHalcon״ģͲȡ쳣ɵߴ
+		*/
+		void buildShapeModel(
+			const HalconCpp::HObject& image,
+			const HalconCpp::HObject& region,
+			const TemplateConfig& config,
+			HalconCpp::HTuple& modelId,
+			HalconCpp::HObject& contour
+		) const;
+
+		/*
+			@brief ̨ؽģͲԭ滻ģϢ
+		*/
+		void rebuildTemplate(
+			int templateId,
+			int generation,
+			const HalconCpp::HObject& image,
+			const HalconCpp::HObject& region,
+			const TemplateConfig& config
+		);
+
+		/*
+			@brief ģģԭתԳƽģͱԵļռդ
+		*/
+		static int detectRotationalSymmetry(
+			const HalconCpp::HObject& image,
+			const HalconCpp::HObject& region,
+			int contrast
+		);
+
+		/*
+			@brief autoSymmetryʱԳƽǶȷΧСһԳ
+		*/
+		static TemplateConfig applySymmetryReduction(
+			const HalconCpp::HObject& image,
+			const HalconCpp::HObject& region,
+			const TemplateConfig& config
+		);
+
+		/*
+			@brief жñ仯ǷҪؽģ
+		*/
+		static bool configRequiresRebuild(const TemplateConfig& current, const TemplateConfig& target);
+
 		/*
 			@brief ȡһõģID
 		*/
@@ -315,6 +428,46 @@ class ShapeBasedMatching {
 			bool isSubpixel
 		) const;
 
+		/*
+			@brief ȡģ͵ŷΧScaleMin < ScaleMax ʱΪ߶Ȳģͣtrue
+		*/
+		static bool getModelScaleRange(const HalconCpp::HTuple& modelId, double& minScale, double& maxScale);
+
+		/*
+			@brief ̶numThreadṣ̬߳ȡ[0, count)ڵ±ִbody
+			numThreads <= 1  count <= 1 ʱڵǰ߳˳ִ
+		*/
+		static void parallelFor(size_t count, int numThreads, const std::function<void(size_t)>& body);
+
+		/*
+			@brief ׶ƥ䣺ģȫصƣ
+		*/
+		void suppressOverlappingResults(
+			std::vector<MatchingResult>& results,
+			double maxOverlap
+		) const;
+
+		/*
+			@brief ׶ƥ䣺ںѡλõССǶȴ߾ؾλ
+		*/
+		bool refineMatchResult(
+			const HalconCpp::HObject& image,
+			MatchingResult& result,
+			const HalconCpp::HTuple& subPixel
+		) const;
+
+		/*
+			@brief ģ屣/أ: <ģļ>.region.hobjǶȴ: <ģļ>.region.tup
+		*/
+		static bool writeSearchRegion(const TemplateInfo& templateInfo, const std::string& filePath);
+
+		static void readSearchRegion(TemplateInfo& templateInfo, const std::string& filePath);
+
+		/*
+			@brief ģԭӰ뾶
+		*/
+		static double computeModelRadius(const HalconCpp::HObject& contour);
+
 		/*
 			@brief תHalconMatchingResult
 		*/
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <thread>
 #include <sstream>
+#include <QTemporaryDir>
 
 
 using namespace HalconCpp;
@@ -41,6 +42,10 @@ void ShapeBasedMatchingDemo::runAllTests()
 	runTest("ģ", testTemplateManagement);
 	runTest("ģ־û", testTemplatePersistence);
 	runTest("", testBatchOperations);
+	runTest("׶ƥ", testTwoPhaseMatching);
+	runTest("ģ", testSearchRegionMatching);
+	runTest("ģؽ滻", testTemplateHotSwap);
+	runTest("תԳƼ", testRotationalSymmetry);
 
 	// ܽ
 	cout << "\n" << string(50, '=') << endl;
@@ -178,6 +183,151 @@ void ShapeBasedMatchingDemo::testImagePreprocessing()
 	}
 }
 
+// 10׶ƥ䣨 + λ
+void ShapeBasedMatchingDemo::testTwoPhaseMatching()
+{
+	ShapeBasedMatching matcher;
+	HObject circleImage = createCircleImage(200, 200, 50);
+	HObject circleRegion;
+	GenCircle(&circleRegion, 100, 100, 50);
+	int templateId = matcher.createTemplate(circleImage, circleRegion, "TwoPhaseCircle");
+	if (templateId == -1) {
+		throw runtime_error("ģ崴ʧ");
+	}
+	vector<MatchingResult> singlePhase, twoPhase;
+	matcher.findMultipleTemplatesOptimized(circleImage, { templateId }, singlePhase,
+		0.5, 3, 0.8, true, true, 1, false);
+	if (!matcher.findMultipleTemplatesOptimized(circleImage, { templateId }, twoPhase,
+		0.5, 3, 0.8, true, true, 1, true)) {
+		throw runtime_error("׶ƥδҵ");
+	}
+	if (!singlePhase.empty() && !compareResults(singlePhase[0], twoPhase[0], 0.5)) {
+		throw runtime_error("׶ƥ뵥׶νһ");
+	}
+	cout << " ׶ƥɹ: row=" << twoPhase[0].row << ", col=" << twoPhase[0].column
+		<< ", score=" << twoPhase[0].score << endl;
+}
+
+// 11ģ޶ + ־û
+void ShapeBasedMatchingDemo::testSearchRegionMatching()
+{
+	ShapeBasedMatching matcher;
+	HObject circleImage = createCircleImage(200, 200, 50);
+	HObject circleRegion;
+	GenCircle(&circleRegion, 100, 100, 50);
+	int templateId = matcher.createTemplate(circleImage, circleRegion, "RegionCircle");
+	if (templateId == -1) {
+		throw runtime_error("ģ崴ʧ");
+	}
+	// ڰĿ꣺Ӧҵ
+	HObject zone;
+	GenRectangle1(&zone, 80, 80, 120, 120);
+	if (!matcher.setTemplateSearchRegion(templateId, zone)) {
+		throw runtime_error("ʧ");
+	}
+	vector<MatchingResult> results;
+	if (!matcher.findTemplate(circleImage, templateId, results)) {
+		throw runtime_error("δҵĿ");
+	}
+	// 򲻰Ŀ꣺Ӧҵ
+	HObject farZone;
+	GenRectangle1(&farZone, 0, 0, 20, 20);
+	matcher.setTemplateSearchRegion(templateId, farZone);
+	if (matcher.findTemplate(circleImage, templateId, results)) {
+		throw runtime_error("ȻҵĿ");
+	}
+	// ģ屣ͼأģ弰ļдʱĿ¼ԽĿ¼ɾ
+	QTemporaryDir tempDir;
+	if (!tempDir.isValid()) {
+		throw runtime_error("ʱĿ¼ʧ");
+	}
+	string filePath = tempDir.filePath("region_template_test.shm").toLocal8Bit().toStdString();
+	if (!matcher.saveTemplate(templateId, filePath)) {
+		throw runtime_error("ģ屣ʧ");
+	}
+	int loadedId = matcher.loadTemplate(filePath, "RegionCircleLoaded");
+	HObject loadedZone;
+	double angleStart = 0, angleExtent = 0;
+	if (loadedId == -1 || !matcher.getTemplateSearchRegion(loadedId, loadedZone, angleStart, angleExtent)) {
+		throw runtime_error("δģ");
+	}
+	cout << " ޶־ûɹ" << endl;
+}
+
+// 12ģø£̨ؽ + ԭ滻
+void ShapeBasedMatchingDemo::testTemplateHotSwap()
+{
+	ShapeBasedMatching matcher;
+	HObject circleImage = createCircleImage(200, 200, 50);
+	HObject circleRegion;
+	GenCircle(&circleRegion, 100, 100, 50);
+	int templateId = matcher.createTemplate(circleImage, circleRegion, "HotSwapCircle");
+	if (templateId == -1) {
+		throw runtime_error("ģ崴ʧ");
+	}
+	TemplateConfig newConfig;
+	matcher.getTemplateConfig(templateId, newConfig);
+	newConfig.tmpName = "HotSwapCircleV2";
+	newConfig.angleStart = -1.0;
+	newConfig.angleExtent = 2.0;
+	newConfig.contrast = 20;
+	if (!matcher.updateTemplateConfig(templateId, newConfig)) {
+		throw runtime_error("ģøʧ");
+	}
+	// ؽڼģͼṩƥ
+	vector<MatchingResult> results;
+	if (!matcher.findTemplate(circleImage, templateId, results)) {
+		throw runtime_error("ؽڼƥʧ");
+	}
+	matcher.waitForPendingRebuilds();
+	TemplateConfig rebuiltConfig;
+	if (!matcher.getTemplateConfig(templateId, rebuiltConfig) ||
+		fabs(rebuiltConfig.angleExtent - newConfig.angleExtent) > 0.01 ||
+		rebuiltConfig.tmpName != newConfig.tmpName) {
+		throw runtime_error("ؽģòƥ");
+	}
+	if (!matcher.findTemplate(circleImage, templateId, results)) {
+		throw runtime_error("ؽƥʧ");
+	}
+	cout << " ģ̨ؽ滻ɹ" << endl;
+}
+
+// 13תԳƼǶȷΧС
+void ShapeBasedMatchingDemo::testRotationalSymmetry()
+{
+	ShapeBasedMatching matcher;
+	TemplateConfig config;
+	config.tmpName = "SymmetricRect";
+	config.angleStart = 0.0;
+	config.angleExtent = 2.0 * m_PI;
+	config.autoSymmetry = true;
+	// Ϊ2׶Գ
+	HObject rectImage = createRectangleImage(300, 300, 100, 150);
+	HObject rectRegion;
+	GenRectangle1(&rectRegion, 60, 60, 240, 240);
+	int templateId = matcher.createTemplateAdvanced(rectImage, rectRegion, config);
+	if (templateId == -1) {
+		throw runtime_error("Գģ崴ʧ");
+	}
+	TemplateConfig retrievedConfig;
+	matcher.getTemplateConfig(templateId, retrievedConfig);
+	if (retrievedConfig.symmetryOrder != 2 || retrievedConfig.angleExtent > m_PI + 0.01) {
+		throw runtime_error("ζԳƽ");
+	}
+	if (fabs(retrievedConfig.angleStart - config.angleStart) > 1e-9) {
+		throw runtime_error("СǶȷΧʱıûʼ");
+	}
+	vector<MatchingResult> results;
+	if (!matcher.findTemplate(rectImage, templateId, results)) {
+		throw runtime_error("Գģƥʧ");
+	}
+	if (results[0].angle < config.angleStart - 1e-6 || results[0].angle > config.angleStart + m_PI + 1e-6) {
+		throw runtime_error("ؽǶδһԳ");
+	}
+	cout << " תԳƼɹ: =" << retrievedConfig.symmetryOrder
+		<< ", ǶȷΧ=" << retrievedConfig.angleExtent << endl;
+}
+
 // 3ģƥ
 
 
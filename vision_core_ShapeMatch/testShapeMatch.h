@@ -31,6 +31,14 @@ public:
 
 	static void testBatchOperations();
 
+	static void testTwoPhaseMatching();
+
+	static void testSearchRegionMatching();
+
+	static void testTemplateHotSwap();
+
+	static void testRotationalSymmetry();
+
 private:
 	// 
 	static HalconCpp::HObject createCircleImage(int width, int height, int radius);
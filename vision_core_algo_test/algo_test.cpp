@@ -0,0 +1,330 @@
+﻿#include "algo_test.h"
+#include "circlefit_algorithm.h"
+#include "irls_circle_solver.h"
+#include "caliper_engine.h"
+#include "roi_alignment.h"
+#include "roi_shape.h"
+#include "rle_region.h"
+#include "algorithm_input.h"
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+
+using namespace HalconCpp;
+using namespace std;
+
+// 运行所有测试
+int VisionAlgoTest::runAllTests()
+{
+	cout << "====================================" << endl;
+	cout << " 算法插件功能测试开始 " << endl;
+	cout << "====================================" << endl;
+	int testCount = 0;
+	int passedCount = 0;
+
+	auto runTest = [&](const string& testName, void(*testFunc)()) {
+		cout << "\n[" << ++testCount << "] 测试: " << testName << endl;
+		cout << string(50, '-') << endl;
+		try {
+			testFunc();
+			cout << testName << " 测试通过" << endl;
+			passedCount++;
+		} catch (const exception& ex) {
+			cout << testName << " 测试失败: " << ex.what() << endl;
+		} catch (HException& ex) {
+			cout << testName << " 测试失败: " << ex.ErrorMessage().Text() << endl;
+		}
+	};
+	// 运行各个测试
+	runTest("圆拟合位姿对齐管控", testCircleFitAlignedTolerance);
+	runTest("几何LM初值点数不足", testGeometricSeedTooFewPoints);
+	runTest("连续跟踪无边缘判NG", testCircleFitTemporalNoEdges);
+	runTest("界面测试后保留圆环管控", testCircleFitToleranceAfterTest);
+	runTest("连续跟踪热启动初值", testCircleFitWarmStartSeed);
+	runTest("游程最小外接矩形与Halcon一致", testRleSmallestRectangle2Parity);
+	runTest("原生卡尺与MeasurePos一致", testCaliperEngineMeasurePosParity);
+
+	// 输出测试总结
+	cout << "\n" << string(50, '=') << endl;
+	cout << "测试总结:" << endl;
+	cout << "总测试数: " << testCount << endl;
+	cout << "通过数: " << passedCount << endl;
+	cout << "失败数: " << (testCount - passedCount) << endl;
+	return testCount - passedCount;
+}
+
+void VisionAlgoTest::check(bool condition, const std::string& message)
+{
+	if (!condition) {
+		throw runtime_error(message);
+	}
+}
+
+namespace {
+	// 暗背景上的亮圆环线（半径r±2），从内向外或从外向内测量的第一个边缘都是从暗到明
+	QImage createRingLineImage(int width, int height, double cx, double cy, double radius)
+	{
+		QImage image(width, height, QImage::Format_Grayscale8);
+		for (int y = 0; y < height; ++y) {
+			uchar* line = image.scanLine(y);
+			for (int x = 0; x < width; ++x) {
+				double d = std::hypot(x - cx, y - cy);
+				line[x] = std::fabs(d - radius) <= 2.0 ? 220 : 30;
+			}
+		}
+		return image;
+	}
+}
+
+// 圆环ROI和标准圆心绘制在模板图像上；零件平移旋转后，按上下文中的位姿对齐应判OK，不对齐应判NG
+void VisionAlgoTest::testCircleFitAlignedTolerance()
+{
+	const double roiX = 240.0, roiY = 240.0;
+	RoiAlignment alignment = RoiAlignment::fromPoses(200.0, 200.0, 0.0, 209.0, 212.0, 0.05);
+	QPointF partCenter = alignment.mapPoint(QPointF(roiX, roiY));
+	cout << "当前圆心: (" << partCenter.x() << ", " << partCenter.y() << ")" << endl;
+
+	RoiRing ring(QPointF(roiX, roiY), 60.0, 100.0);
+	QJsonObject tolerance;
+	tolerance["std_cx"] = roiX;
+	tolerance["std_cy"] = roiY;
+	tolerance["std_radius"] = 80.0;
+	tolerance["permissibleErr"] = 3.0;
+	QJsonObject params;
+	params["rois"] = QJsonArray{ ring.toJson() };
+	params["ring_tolerances"] = QJsonArray{ tolerance };
+
+	CircleFitAlgorithm algorithm;
+	algorithm.initialize();
+	algorithm.setParameters(params);
+
+	AlgorithmContext aligned;
+	aligned.input.addImage(createRingLineImage(480, 480, partCenter.x(), partCenter.y(), 80.0));
+	aligned.setData(RoiAlignment::contextKey(), RoiAlignment::poseToVariant(200.0, 200.0, 0.0, 209.0, 212.0, 0.05));
+	AlgorithmResult result = algorithm.run(aligned);
+	check(result.code() == 0, "对齐运行出错: " + result.msg().toStdString());
+	check(result.resultType() == ResultType::OK, "位姿对齐后应判OK");
+
+	AlgorithmContext unaligned;
+	unaligned.input.addImage(createRingLineImage(480, 480, partCenter.x(), partCenter.y(), 80.0));
+	result = algorithm.run(unaligned);
+	check(result.code() == 0, "未对齐运行出错: " + result.msg().toStdString());
+	check(result.resultType() == ResultType::NG, "未对齐时圆心偏移应判NG");
+}
+
+// 有初值的几何LM在点数不足3个时应返回无效圆，而不是原样返回初值
+void VisionAlgoTest::testGeometricSeedTooFewPoints()
+{
+	IrlsCircleSolver solver;
+	FitConfig config;
+	Circle seed(100.0, 100.0, 50.0);
+	for (size_t n = 0; n < 3; ++n) {
+		std::vector<Pointf> pts;
+		for (size_t i = 0; i < n; ++i) {
+			double a = 2.0 * i;
+			pts.push_back(Pointf(100.0 + 50.0 * std::cos(a), 100.0 + 50.0 * std::sin(a)));
+		}
+		Circle circle = solver.fitGeometric(pts, config, IrlsCircleSolver::Tukey, &seed);
+		check(circle.radius == 0.0 && !circle.IsConverged, "点数" + to_string(n) + "时应返回无效圆");
+	}
+}
+
+// 连续跟踪热启动后，下一帧没有边缘时不应以上一帧的初值判OK
+void VisionAlgoTest::testCircleFitTemporalNoEdges()
+{
+	RoiRing ring(QPointF(240.0, 240.0), 60.0, 100.0);
+	QJsonObject tolerance;
+	tolerance["std_cx"] = 240.0;
+	tolerance["std_cy"] = 240.0;
+	tolerance["std_radius"] = 80.0;
+	tolerance["permissibleErr"] = 3.0;
+	QJsonObject params;
+	params["rois"] = QJsonArray{ ring.toJson() };
+	params["ring_tolerances"] = QJsonArray{ tolerance };
+
+	const char* methods[] = { "IRLS", "几何LM" };
+	for (const char* method : methods) {
+		CircleFitAlgorithm algorithm;
+		algorithm.initialize();
+		algorithm.getPropertyObj()->setPropValue("temporal_mode", "开启");
+		algorithm.getPropertyObj()->setPropValue("fit_method", QString::fromUtf8(method));
+		algorithm.setParameters(params);
+
+		AlgorithmContext first;
+		first.input.addImage(createRingLineImage(480, 480, 240.0, 240.0, 80.0));
+		AlgorithmResult result = algorithm.run(first);
+		check(result.resultType() == ResultType::OK, string(method) + ": 首帧应判OK");
+
+		QImage blank(480, 480, QImage::Format_Grayscale8);
+		blank.fill(30);
+		AlgorithmContext second;
+		second.input.addImage(blank);
+		result = algorithm.run(second);
+		check(result.code() == 0, string(method) + ": 无边缘帧运行出错: " + result.msg().toStdString());
+		check(result.resultType() == ResultType::NG, string(method) + ": 无边缘帧应判NG");
+	}
+}
+
+// 界面测试按绘制的ROI重建圆环后，配方中单独配置的圆环管控参数仍应生效
+void VisionAlgoTest::testCircleFitToleranceAfterTest()
+{
+	auto ring = std::make_shared<RoiRing>(QPointF(240.0, 240.0), 60.0, 100.0);
+	QJsonObject tolerance;
+	tolerance["std_cx"] = 240.0;
+	tolerance["std_cy"] = 240.0;
+	tolerance["std_radius"] = 80.0;
+	tolerance["permissibleErr"] = 3.0;
+	QJsonObject params;
+	params["rois"] = QJsonArray{ ring->toJson() };
+	params["ring_tolerances"] = QJsonArray{ tolerance };
+
+	CircleFitAlgorithm algorithm;
+	algorithm.initialize();
+	algorithm.setParameters(params);
+
+	// 默认标准圆（150, 250, 250）与该圆环不符，只有单独配置的管控参数能判OK
+	QImage image = createRingLineImage(480, 480, 240.0, 240.0, 80.0);
+	AlgorithmInput input;
+	input.addImage(image);
+	input.setRoiShapes({ ring });
+	AlgorithmResult result = algorithm.test(input);
+	check(result.code() == 0, "界面测试出错: " + result.msg().toStdString());
+
+	AlgorithmContext context;
+	context.input.addImage(image);
+	result = algorithm.run(context);
+	check(result.code() == 0, "运行出错: " + result.msg().toStdString());
+	check(result.resultType() == ResultType::OK, "界面测试后单独配置的管控参数丢失");
+}
+
+// 连续跟踪时圆环中心向偏心的静止零件漂移，下一帧交给fitWarm/fitGeometric的初值仍应等于上一帧结果
+void VisionAlgoTest::testCircleFitWarmStartSeed()
+{
+	RoiRing ring(QPointF(240.0, 240.0), 60.0, 100.0);
+	QJsonObject params;
+	params["rois"] = QJsonArray{ ring.toJson() };
+
+	AlgorithmInput input;
+	input.addImage(createRingLineImage(480, 480, 246.0, 243.0, 80.0));
+	HObject image = input.getImageAsHObject(0);
+
+	const char* methods[] = { "IRLS", "几何LM" };
+	for (const char* method : methods) {
+		CircleFitAlgorithm algorithm;
+		algorithm.initialize();
+		algorithm.getPropertyObj()->setPropValue("temporal_mode", "开启");
+		algorithm.getPropertyObj()->setPropValue("follow_rate", 0.5);
+		algorithm.getPropertyObj()->setPropValue("fit_method", QString::fromUtf8(method));
+		algorithm.setParameters(params);
+
+		for (int frame = 0; frame < 3; ++frame) {
+			auto measurements = algorithm.measureRings(image, RoiAlignment());
+			check(measurements.size() == 1 && measurements[0].err == 0, string(method) + ": 测量出错");
+			const Circle& fitted = measurements[0].circle;
+			const CircleFitAlgorithm::RingContext& context = *algorithm.rings_[0];
+			check(context.hasLast && (context.drift.x != 0.0 || context.drift.y != 0.0), string(method) + ": 圆环中心应跟随漂移");
+			Circle seed = CircleFitAlgorithm::warmStartSeed(context, context.center);
+			cout << method << " 第" << frame + 1 << "帧: 拟合(" << fitted.center_x << ", " << fitted.center_y << ", " << fitted.radius
+				<< ") 下一帧初值(" << seed.center_x << ", " << seed.center_y << ", " << seed.radius << ")" << endl;
+			check(std::fabs(seed.center_x - fitted.center_x) < 1e-9 && std::fabs(seed.center_y - fitted.center_y) < 1e-9
+				&& std::fabs(seed.radius - fitted.radius) < 1e-9, string(method) + ": 热启动初值偏离上一帧结果");
+		}
+	}
+}
+
+// 游程连通域的最小外接矩形与Halcon SmallestRectangle2逐项比较（按像素中心计算）
+void VisionAlgoTest::testRleSmallestRectangle2Parity()
+{
+	const double pi = 3.14159265358979323846;
+	HObject rect, rotated, ellipse, polygon;
+	GenRectangle1(&rect, 10, 20, 19, 119);
+	GenRectangle2(&rotated, 200.0, 240.0, 0.6, 80.0, 25.0);
+	GenEllipse(&ellipse, 300.0, 120.0, -0.35, 60.0, 20.0);
+	GenRegionPolygonFilled(&polygon, HTuple(400.0).TupleConcat(420.0).TupleConcat(470.0).TupleConcat(455.0),
+		HTuple(300.0).TupleConcat(390.0).TupleConcat(360.0).TupleConcat(310.0));
+	struct Case { const char* name; HObject region; };
+	Case cases[] = { { "10x100矩形", rect }, { "旋转矩形", rotated }, { "椭圆", ellipse }, { "四边形", polygon } };
+
+	for (const auto& item : cases) {
+		RleComponent c = RleComponents::describe(RleRegion::fromHObject(item.region));
+		HTuple row, col, phi, length1, length2, area;
+		SmallestRectangle2(item.region, &row, &col, &phi, &length1, &length2);
+		AreaCenter(item.region, &area, nullptr, nullptr);
+		cout << item.name << ": L1 " << c.rect.length1 << " / " << length1.D()
+			<< ", L2 " << c.rect.length2 << " / " << length2.D() << endl;
+		const string name = item.name;
+		check(c.area == area.L(), name + ": 面积不一致");
+		check(fabs(c.rect.length1 - length1.D()) < 1e-3, name + ": length1不一致");
+		check(fabs(c.rect.length2 - length2.D()) < 1e-3, name + ": length2不一致");
+		check(fabs(c.rect.row - row.D()) < 1e-3 && fabs(c.rect.col - col.D()) < 1e-3, name + ": 中心不一致");
+		double dphi = fabs(std::remainder(c.rect.phi - phi.D(), pi));
+		check(dphi < 1e-3, name + ": phi不一致");
+		check(fabs(c.fillRatio - c.area / (4.0 * length1.D() * length2.D())) < 1e-6, name + ": 填充率不一致");
+	}
+
+	RleComponent block = RleComponents::describe(RleRegion::fromHObject(rect));
+	check(fabs(block.rect.length1 - 49.5) < 1e-9 && fabs(block.rect.length2 - 4.5) < 1e-9, "10x100矩形应为L1=49.5, L2=4.5");
+}
+
+// 原生卡尺引擎（SSE2剖面/导数）与Halcon MeasurePos逐卡尺比较，边缘数一致且位置偏差不超过0.05像素
+void VisionAlgoTest::testCaliperEngineMeasurePosParity()
+{
+	const int width = 640, height = 480;
+	const double cx = 320.3, cy = 240.7, radius = 150.25;
+	// 亮背景(210)上的暗圆盘，高斯平滑得到亚像素过渡
+	HObject blank, background, painted, image, full, disk;
+	GenImageConst(&blank, "byte", width, height);
+	GenRectangle1(&full, 0, 0, height - 1, width - 1);
+	PaintRegion(full, blank, &background, 210, "fill");
+	GenCircle(&disk, cy, cx, radius);
+	PaintRegion(disk, background, &painted, 40, "fill");
+	GaussFilter(painted, &image, 5);
+
+	// 径向卡尺（半长20、半宽5，与圆拟合插件一致）
+	std::vector<CaliperEngine::Geometry> geometries;
+	const double pi = 3.14159265358979323846;
+	for (int i = 0; i < 72; ++i) {
+		double phi = i * 5.0 * pi / 180.0;
+		geometries.push_back({ cy - radius * std::sin(phi), cx + radius * std::cos(phi), phi, 20.0, 5.0 });
+	}
+
+	const double sigma = 1.0, threshold = 15.0;
+	CaliperEngine engine;
+	engine.prepare(geometries, width, height, sigma);
+	CaliperEngine::EdgeOptions options;
+	options.threshold = threshold;
+	options.transition = CaliperEngine::All;
+	options.select = CaliperEngine::AllPoints;
+
+	HTuple pointer, type, w, h;
+	GetImagePointer1(image, &pointer, &type, &w, &h);
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(pointer.L());
+	std::vector<CaliperEngine::EdgePoint> edges;
+	std::vector<float> profile;
+	double maxDiff = 0.0;
+	int edgeCount = 0;
+	for (size_t i = 0; i < geometries.size(); ++i) {
+		const auto& g = geometries[i];
+		HTuple handle, rowEdge, colEdge, amplitude, distance;
+		GenMeasureRectangle2(g.row, g.col, g.phi, g.length1, g.length2, width, height, "bilinear", &handle);
+		MeasurePos(image, handle, sigma, threshold, "all", "all", &rowEdge, &colEdge, &amplitude, &distance);
+		CloseMeasure(handle);
+		engine.measureCaliper(i, data, w.I(), options, &edges, &profile);
+		check(static_cast<int>(edges.size()) == rowEdge.Length(), "卡尺" + to_string(i) + "边缘数不一致");
+		for (size_t k = 0; k < edges.size(); ++k) {
+			double d = std::hypot(edges[k].row - rowEdge[static_cast<int>(k)].D(), edges[k].col - colEdge[static_cast<int>(k)].D());
+			maxDiff = std::max(maxDiff, d);
+			check((edges[k].amplitude > 0) == (amplitude[static_cast<int>(k)].D() > 0), "卡尺" + to_string(i) + "边缘极性不一致");
+		}
+		edgeCount += static_cast<int>(edges.size());
+	}
+	cout << "边缘数: " << edgeCount << ", 最大位置偏差: " << maxDiff << " px" << endl;
+	check(edgeCount > 0, "未测得边缘");
+	check(maxDiff <= 0.05, "边缘位置偏差超过0.05像素");
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#ifndef VISION_ALGO_TEST_H
+#define VISION_ALGO_TEST_H
+
+#include <string>
+
+
+/*
+    算法插件功能测试 ---- 圆拟合、卡尺、区域等不依赖界面的算法逻辑
+    每个测试失败时抛出std::runtime_error
+*/
+class VisionAlgoTest {
+public:
+	// 运行所有测试，返回失败的测试数
+	static int runAllTests();
+
+	// 单个功能测试
+	static void testCircleFitAlignedTolerance();
+
+	static void testGeometricSeedTooFewPoints();
+
+	static void testCircleFitTemporalNoEdges();
+
+	static void testCircleFitToleranceAfterTest();
+
+	static void testCircleFitWarmStartSeed();
+
+	static void testRleSmallestRectangle2Parity();
+
+	static void testCaliperEngineMeasurePosParity();
+
+private:
+	// 辅助函数
+	static void check(bool condition, const std::string& message);
+};
+
+
+#endif		// VISION_ALGO_TEST_H
@@ -0,0 +1,11 @@
+﻿#include "algo_test.h"
+#include <QCoreApplication>
+
+
+// ================  算法插件功能测试 ================= //
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	int failed = VisionAlgoTest::runAllTests();
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include "circlefit_bench.h"
+#include "irls_circle_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+
+namespace {
+    const double kPi = 3.14159265358979323846;
+
+    // 被测求解器：名称 + 拟合函数（求解器实例在样本间复用，与插件的稳态一致）
+    struct SolverEntry {
+        std::string name;
+        std::function<Circle(IrlsCircleSolver&, const std::vector<Pointf>&)> fit;
+    };
+
+    std::vector<SolverEntry> solverEntries()
+    {
+        FitConfig config;
+        std::vector<SolverEntry> solvers;
+        solvers.push_back({ "SimpleLS", [](IrlsCircleSolver&, const std::vector<Pointf>& pts) {
+            return IrlsCircleSolver::fitSimpleLS(pts);
+        } });
+        // fitCircleIRLSOptimized / fitCircleIRLSOptimized_plus 均委托给IrlsCircleSolver::fit（_plus只多一次管控判断）
+        solvers.push_back({ "IRLS_tukey", [config](IrlsCircleSolver& s, const std::vector<Pointf>& pts) {
+            return s.fit(pts, config, IrlsCircleSolver::Tukey);
+        } });
+        solvers.push_back({ "IRLS_huber", [config](IrlsCircleSolver& s, const std::vector<Pointf>& pts) {
+            return s.fit(pts, config, IrlsCircleSolver::Huber);
+        } });
+        solvers.push_back({ "LM_tukey", [config](IrlsCircleSolver& s, const std::vector<Pointf>& pts) {
+            return s.fitGeometric(pts, config, IrlsCircleSolver::Tukey);
+        } });
+        solvers.push_back({ "Consensus_tukey", [config](IrlsCircleSolver& s, const std::vector<Pointf>& pts) {
+            return s.fitConsensus(pts, config, IrlsCircleSolver::Tukey, 2.0);
+        } });
+        return solvers;
+    }
+
+    std::string jsonEscape(const std::string& text)
+    {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+}
+
+std::vector<BenchScenario> CircleFitBenchmark::defaultScenarios(bool quick)
+{
+    const std::vector<int> counts = quick ? std::vector<int>{ 8, 36, 1024 }
+        : std::vector<int>{ 8, 16, 36, 128, 1024, 10000 };
+    // 噪声 / 离群点比例 / 圆弧张角的组合
+    struct Condition {
+        const char* name;
+        double noise;
+        double outlierRatio;
+        double arcDeg;
+    };
+    const Condition conditions[] = {
+        { "clean",        0.2, 0.0,  360.0 },
+        { "noisy",        1.0, 0.0,  360.0 },
+        { "outlier10",    0.2, 0.1,  360.0 },
+        { "outlier30",    0.2, 0.3,  360.0 },
+        { "arc90",        0.2, 0.0,  90.0 },
+        { "arc90_out10",  0.2, 0.1,  90.0 },
+    };
+
+    std::vector<BenchScenario> scenarios;
+    for (const auto& cond : conditions) {
+        for (int n : counts) {
+            BenchScenario s;
+            s.points = n;
+            s.noise = cond.noise;
+            s.outlierRatio = cond.outlierRatio;
+            s.arcDeg = cond.arcDeg;
+            // 每个场景总点数大致相同，保证大点数场景耗时可控
+            s.trials = std::max(10, std::min(1000, 200000 / n));
+            if (quick) {
+                s.trials = std::max(5, s.trials / 10);
+            }
+            s.name = std::string(cond.name) + "_n" + std::to_string(n);
+            scenarios.push_back(s);
+        }
+    }
+    return scenarios;
+}
+
+std::vector<CircleFitBenchmark::Sample> CircleFitBenchmark::generate(const BenchScenario& scenario, std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> gauss(0.0, scenario.noise);
+    const double span = scenario.arcDeg * kPi / 180.0;
+    const bool fullCircle = scenario.arcDeg >= 360.0;
+
+    std::vector<Sample> samples(scenario.trials);
+    for (auto& sample : samples) {
+        // 圆心/半径取自产线常见范围
+        sample.truth = Circle(500.0 + 1000.0 * uniform(rng), 500.0 + 1000.0 * uniform(rng), 50.0 + 450.0 * uniform(rng));
+        const double start = 2.0 * kPi * uniform(rng);
+        const double step = fullCircle ? span / scenario.points : span / std::max(1, scenario.points - 1);
+        sample.points.resize(scenario.points);
+        for (int i = 0; i < scenario.points; ++i) {
+            // 卡尺角度等间隔，附加少量抖动
+            double angle = start + step * (i + 0.2 * (uniform(rng) - 0.5));
+            double radius = sample.truth.radius;
+            if (uniform(rng) < scenario.outlierRatio) {
+                // 离群点：毛刺/缺口造成的径向偏移，5~30像素，70%向外
+                double offset = 5.0 + 25.0 * uniform(rng);
+                radius += (uniform(rng) < 0.7) ? offset : -offset;
+            }
+            sample.points[i].x = sample.truth.center_x + radius * std::cos(angle) + gauss(rng);
+            sample.points[i].y = sample.truth.center_y + radius * std::sin(angle) + gauss(rng);
+        }
+    }
+    return samples;
+}
+
+std::vector<BenchStats> CircleFitBenchmark::run(const std::vector<BenchScenario>& scenarios, unsigned int seed)
+{
+    using clock = std::chrono::steady_clock;
+    const auto solvers = solverEntries();
+    std::vector<BenchStats> stats;
+    std::mt19937 rng(seed);
+    IrlsCircleSolver solver;
+    std::vector<Circle> fitted;
+
+    for (const auto& scenario : scenarios) {
+        const auto samples = generate(scenario, rng);
+        fitted.resize(samples.size());
+        for (const auto& entry : solvers) {
+            // 预热一次（工作区分配），计时段只包含拟合本身
+            fitted[0] = entry.fit(solver, samples[0].points);
+            auto begin = clock::now();
+            for (size_t i = 0; i < samples.size(); ++i) {
+                fitted[i] = entry.fit(solver, samples[i].points);
+            }
+            auto end = clock::now();
+
+            BenchStats st;
+            st.scenario = scenario.name;
+            st.solver = entry.name;
+            st.points = scenario.points;
+            st.trials = static_cast<int>(samples.size());
+            st.nsPerFit = std::chrono::duration<double, std::nano>(end - begin).count() / samples.size();
+            int valid = 0;
+            for (size_t i = 0; i < samples.size(); ++i) {
+                const Circle& c = fitted[i];
+                const Circle& t = samples[i].truth;
+                if (!(c.radius > 0) || !std::isfinite(c.center_x) || !std::isfinite(c.center_y) || !std::isfinite(c.radius)) {
+                    ++st.failed;
+                    continue;
+                }
+                double centerErr = std::hypot(c.center_x - t.center_x, c.center_y - t.center_y);
+                double radiusErr = std::abs(c.radius - t.radius);
+                st.centerErrMean += centerErr;
+                st.radiusErrMean += radiusErr;
+                st.centerErrMax = std::max(st.centerErrMax, centerErr);
+                st.radiusErrMax = std::max(st.radiusErrMax, radiusErr);
+                st.converged += c.IsConverged ? 1 : 0;
+                ++valid;
+            }
+            if (valid > 0) {
+                st.centerErrMean /= valid;
+                st.radiusErrMean /= valid;
+            }
+            stats.push_back(st);
+        }
+    }
+    return stats;
+}
+
+void CircleFitBenchmark::printTable(const std::vector<BenchStats>& stats)
+{
+    std::cout << std::left << std::setw(22) << "scenario" << std::setw(17) << "solver"
+        << std::right << std::setw(12) << "ns/fit" << std::setw(11) << "c_mean" << std::setw(11) << "c_max"
+        << std::setw(11) << "r_mean" << std::setw(11) << "r_max" << std::setw(7) << "conv" << std::setw(6) << "fail" << std::endl;
+    std::cout << std::string(108, '-') << std::endl;
+    for (const auto& st : stats) {
+        std::cout << std::left << std::setw(22) << st.scenario << std::setw(17) << st.solver << std::right
+            << std::fixed << std::setprecision(0) << std::setw(12) << st.nsPerFit
+            << std::setprecision(4) << std::setw(11) << st.centerErrMean << std::setw(11) << st.centerErrMax
+            << std::setw(11) << st.radiusErrMean << std::setw(11) << st.radiusErrMax
+            << std::setw(7) << st.converged << std::setw(6) << st.failed << std::endl;
+    }
+}
+
+bool CircleFitBenchmark::writeJson(const std::vector<BenchStats>& stats, unsigned int seed, const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << std::setprecision(6);
+    file << "{\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& st = stats[i];
+        file << "    {\"scenario\": \"" << jsonEscape(st.scenario) << "\", \"solver\": \"" << jsonEscape(st.solver)
+            << "\", \"points\": " << st.points << ", \"trials\": " << st.trials
+            << ", \"ns_per_fit\": " << st.nsPerFit
+            << ", \"center_err_mean\": " << st.centerErrMean << ", \"center_err_max\": " << st.centerErrMax
+            << ", \"radius_err_mean\": " << st.radiusErrMean << ", \"radius_err_max\": " << st.radiusErrMax
+            << ", \"converged\": " << st.converged << ", \"failed\": " << st.failed << "}"
+            << (i + 1 < stats.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return file.good();
+}
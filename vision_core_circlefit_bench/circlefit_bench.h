@@ -0,0 +1,66 @@
+#ifndef CIRCLEFIT_BENCH_H
+#define CIRCLEFIT_BENCH_H
+#include <string>
+#include <vector>
+#include <random>
+#include "define.h"
+
+
+/*
+    圆拟合精度/吞吐基准 ---- 不依赖Halcon/Qt，直接调用IrlsCircleSolver
+    1. 合成数据按固定种子生成：高斯噪声、离群点比例、部分圆弧、点数8~10k
+    2. 每个场景对各求解器统计单次拟合耗时(ns)、圆心/半径误差、收敛数
+    3. 结果可输出为JSON，便于上线前与历史结果对比发现回退
+*/
+
+// 合成数据场景
+struct BenchScenario {
+    std::string name;
+    int points = 36;            // 每个圆的点数
+    double noise = 0.2;         // 高斯噪声标准差（像素，x/y独立）
+    double outlierRatio = 0.0;  // 离群点比例
+    double arcDeg = 360.0;      // 圆弧张角（度）
+    int trials = 100;           // 圆的个数
+};
+
+// 单个场景 x 求解器的统计结果
+struct BenchStats {
+    std::string scenario;
+    std::string solver;
+    int points = 0;
+    int trials = 0;
+    double nsPerFit = 0.0;
+    double centerErrMean = 0.0;
+    double centerErrMax = 0.0;
+    double radiusErrMean = 0.0;
+    double radiusErrMax = 0.0;
+    int converged = 0;
+    int failed = 0;             // 半径非法/非有限值的次数，不计入误差统计
+};
+
+class CircleFitBenchmark
+{
+public:
+    // 默认场景集，quick为true时只保留少量点数并减少圆的个数
+    static std::vector<BenchScenario> defaultScenarios(bool quick);
+
+    // 运行所有场景和求解器
+    static std::vector<BenchStats> run(const std::vector<BenchScenario>& scenarios, unsigned int seed);
+
+    // 控制台表格
+    static void printTable(const std::vector<BenchStats>& stats);
+
+    // JSON输出，失败返回false
+    static bool writeJson(const std::vector<BenchStats>& stats, unsigned int seed, const std::string& path);
+
+private:
+    struct Sample {
+        std::vector<Pointf> points;
+        Circle truth;
+    };
+
+    // 生成一个场景的全部样本
+    static std::vector<Sample> generate(const BenchScenario& scenario, std::mt19937& rng);
+};
+
+#endif // CIRCLEFIT_BENCH_H
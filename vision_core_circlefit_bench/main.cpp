@@ -0,0 +1,40 @@
+#include "circlefit_bench.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+
+// ================  圆拟合基准测试 ================= //
+// 用法: vision_core_circlefit_bench [--quick] [--seed N] [--json result.json]
+int main(int argc, char* argv[])
+{
+    bool quick = false;
+    unsigned int seed = 20240601u;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--seed N] [--json result.json]" << std::endl;
+            return 2;
+        }
+    }
+
+    auto stats = CircleFitBenchmark::run(CircleFitBenchmark::defaultScenarios(quick), seed);
+    CircleFitBenchmark::printTable(stats);
+    if (!jsonPath.empty()) {
+        if (!CircleFitBenchmark::writeJson(stats, seed, jsonPath)) {
+            std::cerr << "failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "json written to " << jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+﻿#include "result_batch.h"
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+
+using namespace HalconCpp;
+
+// ========================== 点集 ===================== //
+ResultPointBatch::ResultPointBatch(float markerSize)
+    : markerSize_(markerSize)
+{
+}
+
+void ResultPointBatch::reserve(size_t count)
+{
+    xy_.reserve(2 * count);
+}
+
+void ResultPointBatch::clear()
+{
+    xy_.clear();
+}
+
+void ResultPointBatch::add(double x, double y)
+{
+    xy_.push_back(static_cast<float>(x));
+    xy_.push_back(static_cast<float>(y));
+}
+
+void ResultPointBatch::add(const HTuple& rows, const HTuple& cols, int count)
+{
+    int n = std::min(rows.Length(), cols.Length());
+    if (count >= 0 && count < n) {
+        n = count;
+    }
+    reserve(size() + n);
+    for (int i = 0; i < n; ++i) {
+        add(cols[i].D(), rows[i].D());
+    }
+}
+
+std::shared_ptr<ResultPath> ResultPointBatch::toShape(const QColor& color) const
+{
+    if (xy_.empty()) {
+        return nullptr;
+    }
+    QPainterPath path;
+    path.reserve(static_cast<int>(xy_.size() * 5 / 2));
+    for (size_t i = 0; i + 1 < xy_.size(); i += 2) {
+        path.addRect(xy_[i], xy_[i + 1], markerSize_, markerSize_);
+    }
+    return std::make_shared<ResultPath>(path, color);
+}
+
+// ========================== 折线集合 ===================== //
+ResultPolylineBatch::ResultPolylineBatch(double tolerance)
+    : tolerance_(tolerance)
+{
+}
+
+void ResultPolylineBatch::clear()
+{
+    xy_.clear();
+    starts_.clear();
+    closed_.clear();
+}
+
+void ResultPolylineBatch::addPolyline(const float* xy, size_t count, bool closed)
+{
+    if (count == 0) {
+        return;
+    }
+    starts_.push_back(static_cast<uint32_t>(vertexCount()));
+    closed_.push_back(closed ? 1 : 0);
+    if (tolerance_ > 0.0 && count > 2) {
+        simplify(xy, count, tolerance_, &xy_);
+    }
+    else {
+        xy_.insert(xy_.end(), xy, xy + 2 * count);
+    }
+}
+
+void ResultPolylineBatch::addPolyline(const HTuple& rows, const HTuple& cols, bool closed)
+{
+    const int n = std::min(rows.Length(), cols.Length());
+    staging_.resize(2 * static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        staging_[2 * i] = static_cast<float>(cols[i].D());
+        staging_[2 * i + 1] = static_cast<float>(rows[i].D());
+    }
+    addPolyline(staging_.data(), n, closed);
+}
+
+void ResultPolylineBatch::addLine(double x0, double y0, double x1, double y1)
+{
+    const float xy[4] = { static_cast<float>(x0), static_cast<float>(y0), static_cast<float>(x1), static_cast<float>(y1) };
+    addPolyline(xy, 2, false);
+}
+
+void ResultPolylineBatch::addRegions(const HObject& regions, double polygonTolerance, int limit)
+{
+    if (!regions.IsInitialized()) {
+        return;
+    }
+    HTuple count;
+    CountObj(regions, &count);
+    const int drawLimit = std::min(count.I(), limit);
+    for (int i = 1; i <= drawLimit; ++i) {
+        HObject single;
+        SelectObj(regions, &single, i);
+        HTuple rows, cols;
+        try {
+            GetRegionPolygon(single, polygonTolerance, &rows, &cols);
+        }
+        catch (...) {
+            continue;
+        }
+        addPolyline(rows, cols, true);
+    }
+}
+
+void ResultPolylineBatch::addContours(const HObject& contours, bool closed)
+{
+    if (!contours.IsInitialized()) {
+        return;
+    }
+    HTuple count;
+    CountObj(contours, &count);
+    for (int i = 1; i <= count.I(); ++i) {
+        HObject single;
+        SelectObj(contours, &single, i);
+        HTuple rows, cols;
+        GetContourXld(single, &rows, &cols);
+        addPolyline(rows, cols, closed);
+    }
+}
+
+std::shared_ptr<ResultPath> ResultPolylineBatch::toShape(const QColor& color) const
+{
+    if (closed_.empty()) {
+        return nullptr;
+    }
+    QPainterPath path;
+    path.reserve(static_cast<int>(vertexCount() + closed_.size()));
+    const size_t total = vertexCount();
+    for (size_t k = 0; k < starts_.size(); ++k) {
+        const size_t begin = starts_[k];
+        const size_t end = (k + 1 < starts_.size()) ? starts_[k + 1] : total;
+        path.moveTo(xy_[2 * begin], xy_[2 * begin + 1]);
+        for (size_t v = begin + 1; v < end; ++v) {
+            path.lineTo(xy_[2 * v], xy_[2 * v + 1]);
+        }
+        if (closed_[k]) {
+            path.closeSubpath();
+        }
+    }
+    return std::make_shared<ResultPath>(path, color);
+}
+
+size_t ResultPolylineBatch::simplify(const float* xy, size_t count, double tolerance, std::vector<float>* out)
+{
+    if (count <= 2) {
+        out->insert(out->end(), xy, xy + 2 * count);
+        return count;
+    }
+    // keep标记保留的顶点，栈中为待检查的区间[first, last]
+    std::vector<uint8_t> keep(count, 0);
+    keep[0] = 1;
+    keep[count - 1] = 1;
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back({ 0, count - 1 });
+    const double tol2 = tolerance * tolerance;
+    while (!stack.empty()) {
+        const size_t first = stack.back().first;
+        const size_t last = stack.back().second;
+        stack.pop_back();
+        if (last <= first + 1) {
+            continue;
+        }
+        const double ax = xy[2 * first], ay = xy[2 * first + 1];
+        const double dx = xy[2 * last] - ax, dy = xy[2 * last + 1] - ay;
+        const double len2 = dx * dx + dy * dy;
+        double maxDist2 = -1.0;
+        size_t index = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            const double px = xy[2 * i] - ax, py = xy[2 * i + 1] - ay;
+            double dist2;
+            if (len2 > 0.0) {
+                // 点到线段所在直线的距离平方；首尾重合（闭合轮廓）时退化为点距
+                const double cross = px * dy - py * dx;
+                dist2 = cross * cross / len2;
+            }
+            else {
+                dist2 = px * px + py * py;
+            }
+            if (dist2 > maxDist2) {
+                maxDist2 = dist2;
+                index = i;
+            }
+        }
+        if (maxDist2 > tol2) {
+            keep[index] = 1;
+            stack.push_back({ first, index });
+            stack.push_back({ index, last });
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            out->push_back(xy[2 * i]);
+            out->push_back(xy[2 * i + 1]);
+            ++kept;
+        }
+    }
+    return kept;
+}
@@ -0,0 +1,75 @@
+﻿#ifndef RESULT_BATCH_H
+#define RESULT_BATCH_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <QColor>
+
+#define NOMINMAX
+#include <halconCpp/HalconCpp.h>
+#include "result_shape.h"
+
+/*
+    批量结果图形 ---- 边缘点、区域轮廓、骨架等先写入紧凑的float数组（x0, y0, x1, y1, ...），
+    最后合并为一个ResultPath输出：结果构造只分配一次，界面也只绘制一个图形
+*/
+
+// 点集：每个点绘制为markerSize大小的方框（左上角位于点坐标，与ResultRect(QRectF(x, y, s, s))一致）
+class ResultPointBatch
+{
+public:
+    explicit ResultPointBatch(float markerSize = 4.0f);
+
+    void reserve(size_t count);
+    void clear();
+    void add(double x, double y);
+    // Halcon坐标（rows, cols），count < 0时取全部
+    void add(const HalconCpp::HTuple& rows, const HalconCpp::HTuple& cols, int count = -1);
+
+    size_t size() const { return xy_.size() / 2; }
+    bool empty() const { return xy_.empty(); }
+
+    // 合并为一个路径图形，点集为空时返回nullptr
+    std::shared_ptr<ResultPath> toShape(const QColor& color) const;
+
+private:
+    float markerSize_;
+    std::vector<float> xy_;
+};
+
+// 折线集合：tolerance > 0时添加折线即按Douglas-Peucker抽稀（单位为图像像素，0.5约为原始分辨率下的屏幕像素）
+class ResultPolylineBatch
+{
+public:
+    explicit ResultPolylineBatch(double tolerance = 0.0);
+
+    void clear();
+    // xy为count个顶点的交错坐标；closed为true时绘制为闭合多边形
+    void addPolyline(const float* xy, size_t count, bool closed = false);
+    void addPolyline(const HalconCpp::HTuple& rows, const HalconCpp::HTuple& cols, bool closed = false);
+    void addLine(double x0, double y0, double x1, double y1);
+    // 区域边界多边形（GetRegionPolygon），最多绘制limit个区域
+    void addRegions(const HalconCpp::HObject& regions, double polygonTolerance, int limit);
+    // XLD轮廓
+    void addContours(const HalconCpp::HObject& contours, bool closed = false);
+
+    size_t polylineCount() const { return closed_.size(); }
+    size_t vertexCount() const { return xy_.size() / 2; }
+    bool empty() const { return closed_.empty(); }
+
+    // 合并为一个路径图形，没有折线时返回nullptr
+    std::shared_ptr<ResultPath> toShape(const QColor& color) const;
+
+    // Douglas-Peucker抽稀（显式栈，非递归），保留的顶点追加到out，返回保留的顶点数
+    static size_t simplify(const float* xy, size_t count, double tolerance, std::vector<float>* out);
+
+private:
+    double tolerance_;
+    std::vector<float> xy_;
+    std::vector<uint32_t> starts_;      // 每条折线的起始顶点序号
+    std::vector<uint8_t> closed_;
+    std::vector<float> staging_;        // HTuple转换的暂存区
+};
+
+#endif // RESULT_BATCH_H
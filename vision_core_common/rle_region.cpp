@@ -0,0 +1,1004 @@
+﻿#include "rle_region.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+#ifdef USE_HALCON
+using namespace HalconCpp;
+#endif
+
+
+namespace {
+
+// 少于该数量的游程/行不拆分线程
+const size_t kMinRunsPerThread = 4096;
+const int kMinRowsPerThread = 64;
+
+int resolveThreads(int threads, size_t work, size_t minWork)
+{
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    const size_t maxByWork = std::max<size_t>(1, work / minWork);
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(threads, 1), maxByWork)));
+}
+
+// 分块并行：fn(chunk)，chunk为[0, chunks)，chunks为1时在当前线程执行
+template <typename Fn>
+void parallelChunks(int chunks, Fn fn)
+{
+    if (chunks <= 1) {
+        fn(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (int k = 1; k < chunks; ++k) {
+        workers.emplace_back(fn, k);
+    }
+    fn(0);
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+// 分块结果按顺序拼接
+std::vector<RleRun> concatParts(std::vector<std::vector<RleRun>>& parts)
+{
+    size_t total = 0;
+    for (const auto& p : parts) {
+        total += p.size();
+    }
+    std::vector<RleRun> runs;
+    runs.reserve(total);
+    for (auto& p : parts) {
+        runs.insert(runs.end(), p.begin(), p.end());
+    }
+    return runs;
+}
+
+// 同一行上已按colBegin排序的游程，合并重叠/相接的部分后追加到out
+void appendMergedRow(const RleRun* first, const RleRun* last, std::vector<RleRun>* out)
+{
+    if (first == last) {
+        return;
+    }
+    RleRun cur = *first;
+    for (const RleRun* r = first + 1; r != last; ++r) {
+        if (r->colBegin <= cur.colEnd + 1) {
+            cur.colEnd = std::max(cur.colEnd, r->colEnd);
+        }
+        else {
+            out->push_back(cur);
+            cur = *r;
+        }
+    }
+    out->push_back(cur);
+}
+
+// 按行索引游程：rowStart[y - top]为第y行的首个游程，rowStart[y - top + 1]为结束
+struct RowIndex {
+    int top = 0;
+    int bottom = -1;
+    std::vector<size_t> rowStart;
+
+    explicit RowIndex(const std::vector<RleRun>& runs)
+    {
+        if (runs.empty()) {
+            return;
+        }
+        top = runs.front().row;
+        bottom = runs.back().row;
+        rowStart.assign(static_cast<size_t>(bottom - top) + 2, 0);
+        size_t k = 0;
+        for (int y = top; y <= bottom + 1; ++y) {
+            while (k < runs.size() && runs[k].row < y) {
+                ++k;
+            }
+            rowStart[y - top] = k;
+        }
+    }
+
+    // 第y行的游程区间，行不存在时为空
+    void row(int y, size_t* begin, size_t* end) const
+    {
+        if (y < top || y > bottom) {
+            *begin = *end = 0;
+            return;
+        }
+        *begin = rowStart[y - top];
+        *end = rowStart[y - top + 1];
+    }
+};
+
+// 离散圆结构元素：第|dy|行的半宽 floor(sqrt(r^2 - dy^2))
+std::vector<int> circleHalfWidths(double radius)
+{
+    std::vector<int> hw;
+    if (radius < 0.0) {
+        return hw;
+    }
+    const int r = static_cast<int>(std::floor(radius));
+    hw.resize(r + 1);
+    for (int dy = 0; dy <= r; ++dy) {
+        hw[dy] = static_cast<int>(std::floor(std::sqrt(radius * radius - double(dy) * dy) + 1e-9));
+    }
+    return hw;
+}
+
+// 两个单行游程列表求交，结果写入out（覆盖）
+void intersectRow(const std::vector<RleRun>& a, const RleRun* b, const RleRun* bEnd, int shrink,
+    std::vector<RleRun>* out)
+{
+    out->clear();
+    size_t i = 0;
+    while (i < a.size() && b != bEnd) {
+        const int bb = b->colBegin + shrink;
+        const int be = b->colEnd - shrink;
+        if (bb > be) {
+            ++b;
+            continue;
+        }
+        const int lo = std::max(a[i].colBegin, bb);
+        const int hi = std::min(a[i].colEnd, be);
+        if (lo <= hi) {
+            out->push_back({ a[i].row, lo, hi });
+        }
+        if (a[i].colEnd < be) {
+            ++i;
+        }
+        else {
+            ++b;
+        }
+    }
+}
+
+// 游程并查集
+int findRoot(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void unite(std::vector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) {
+        return;
+    }
+    // 较小的索引作为根，保证标签顺序与首个游程一致
+    if (a < b) {
+        parent[b] = a;
+    }
+    else {
+        parent[a] = b;
+    }
+}
+
+// 上一行[prevBegin, prevEnd)与当前行[curBegin, curEnd)的游程连通合并，k为列方向容差(8邻域为1)
+void linkRows(const std::vector<RleRun>& runs, int prevBegin, int prevEnd, int curBegin, int curEnd, int k,
+    std::vector<int>& parent)
+{
+    int j = prevBegin;
+    for (int c = curBegin; c < curEnd; ++c) {
+        while (j < prevEnd && runs[j].colEnd + k < runs[c].colBegin) {
+            ++j;
+        }
+        for (int jj = j; jj < prevEnd && runs[jj].colBegin <= runs[c].colEnd + k; ++jj) {
+            unite(parent, c, jj);
+        }
+    }
+}
+
+// [begin, end)内逐行扫描合并（只访问该区间内的游程）
+void labelRange(const std::vector<RleRun>& runs, int begin, int end, int k, std::vector<int>& parent)
+{
+    int prevBegin = begin, prevEnd = begin;
+    int i = begin;
+    while (i < end) {
+        const int y = runs[i].row;
+        int rowEnd = i;
+        while (rowEnd < end && runs[rowEnd].row == y) {
+            ++rowEnd;
+        }
+        if (prevEnd > prevBegin && runs[prevBegin].row == y - 1) {
+            linkRows(runs, prevBegin, prevEnd, i, rowEnd, k, parent);
+        }
+        prevBegin = i;
+        prevEnd = rowEnd;
+        i = rowEnd;
+    }
+}
+
+} // namespace
+
+// ========================== RleRegion ===================== //
+RleRegion::RleRegion(std::vector<RleRun> runs)
+{
+    std::sort(runs.begin(), runs.end(), [](const RleRun& a, const RleRun& b) {
+        return a.row < b.row || (a.row == b.row && a.colBegin < b.colBegin);
+    });
+    runs_.reserve(runs.size());
+    size_t i = 0;
+    while (i < runs.size()) {
+        size_t j = i;
+        while (j < runs.size() && runs[j].row == runs[i].row) {
+            ++j;
+        }
+        appendMergedRow(runs.data() + i, runs.data() + j, &runs_);
+        i = j;
+    }
+}
+
+RleRegion RleRegion::fromNormalized(std::vector<RleRun> runs)
+{
+    RleRegion region;
+    region.runs_ = std::move(runs);
+    return region;
+}
+
+int64_t RleRegion::area() const
+{
+    int64_t a = 0;
+    for (const auto& r : runs_) {
+        a += r.colEnd - r.colBegin + 1;
+    }
+    return a;
+}
+
+bool RleRegion::boundingBox(int* row1, int* col1, int* row2, int* col2) const
+{
+    if (runs_.empty()) {
+        return false;
+    }
+    *row1 = runs_.front().row;
+    *row2 = runs_.back().row;
+    *col1 = runs_.front().colBegin;
+    *col2 = runs_.front().colEnd;
+    for (const auto& r : runs_) {
+        *col1 = std::min(*col1, static_cast<int>(r.colBegin));
+        *col2 = std::max(*col2, static_cast<int>(r.colEnd));
+    }
+    return true;
+}
+
+RleRegion RleRegion::rectangle1(int row1, int col1, int row2, int col2)
+{
+    std::vector<RleRun> runs;
+    if (row2 >= row1 && col2 >= col1) {
+        runs.reserve(static_cast<size_t>(row2 - row1) + 1);
+        for (int y = row1; y <= row2; ++y) {
+            runs.push_back({ y, col1, col2 });
+        }
+    }
+    return fromNormalized(std::move(runs));
+}
+
+#ifdef USE_HALCON
+RleRegion RleRegion::fromHObject(const HObject& region)
+{
+    if (!region.IsInitialized()) {
+        return RleRegion();
+    }
+    HTuple count;
+    CountObj(region, &count);
+    if (count.I() == 0) {
+        return RleRegion();
+    }
+    HObject single = region;
+    if (count.I() > 1) {
+        Union1(region, &single);
+    }
+    HTuple rows, colBegin, colEnd;
+    GetRegionRuns(single, &rows, &colBegin, &colEnd);
+    const Hlong n = rows.Length();
+    std::vector<RleRun> runs(static_cast<size_t>(n));
+    for (Hlong i = 0; i < n; ++i) {
+        runs[i] = { static_cast<int32_t>(rows[i].L()), static_cast<int32_t>(colBegin[i].L()),
+            static_cast<int32_t>(colEnd[i].L()) };
+    }
+    // Halcon区域本身是规范化的
+    return fromNormalized(std::move(runs));
+}
+
+HObject RleRegion::toHObject() const
+{
+    HObject region;
+    if (runs_.empty()) {
+        GenEmptyRegion(&region);
+        return region;
+    }
+    const Hlong n = static_cast<Hlong>(runs_.size());
+    std::vector<Hlong> rows(n), colBegin(n), colEnd(n);
+    for (Hlong i = 0; i < n; ++i) {
+        rows[i] = runs_[i].row;
+        colBegin[i] = runs_[i].colBegin;
+        colEnd[i] = runs_[i].colEnd;
+    }
+    GenRegionRuns(&region, HTuple(rows.data(), n), HTuple(colBegin.data(), n), HTuple(colEnd.data(), n));
+    return region;
+}
+
+HObject RleRegion::toHObject(const std::vector<RleRegion>& regions)
+{
+    HObject objs;
+    GenEmptyObj(&objs);
+    for (const auto& r : regions) {
+        ConcatObj(objs, r.toHObject(), &objs);
+    }
+    return objs;
+}
+#endif
+
+// ========================== 算子 ===================== //
+namespace RleOps
+{
+
+RleRegion threshold(const uint8_t* image, int width, int height, int stride, const RleRegion& domain,
+    int minGray, int maxGray, int threads)
+{
+    const RleRegion dom = clip(domain, width, height);
+    const std::vector<RleRun>& runs = dom.runs();
+    if (image == nullptr || runs.empty()) {
+        return RleRegion();
+    }
+    bool pass[256];
+    for (int g = 0; g < 256; ++g) {
+        pass[g] = g >= minGray && g <= maxGray;
+    }
+    // 规范化的定义域游程互不相接，各游程的输出互相独立，可按游程任意分块
+    const int chunks = resolveThreads(threads, runs.size(), kMinRunsPerThread);
+    std::vector<std::vector<RleRun>> parts(chunks);
+    parallelChunks(chunks, [&](int k) {
+        const size_t begin = runs.size() * k / chunks;
+        const size_t end = runs.size() * (k + 1) / chunks;
+        std::vector<RleRun>& out = parts[k];
+        for (size_t i = begin; i < end; ++i) {
+            const RleRun& r = runs[i];
+            const uint8_t* p = image + static_cast<size_t>(r.row) * stride;
+            int start = -1;
+            for (int c = r.colBegin; c <= r.colEnd; ++c) {
+                if (pass[p[c]]) {
+                    if (start < 0) {
+                        start = c;
+                    }
+                }
+                else if (start >= 0) {
+                    out.push_back({ r.row, start, c - 1 });
+                    start = -1;
+                }
+            }
+            if (start >= 0) {
+                out.push_back({ r.row, start, r.colEnd });
+            }
+        }
+    });
+    return RleRegion::fromNormalized(concatParts(parts));
+}
+
+int labelRuns(const std::vector<RleRun>& runs, int neighborhood, std::vector<int>* labels, int threads)
+{
+    const int n = static_cast<int>(runs.size());
+    std::vector<int> parent(n);
+    for (int i = 0; i < n; ++i) {
+        parent[i] = i;
+    }
+    const int k = neighborhood == 4 ? 0 : 1;
+
+    // 按行边界分块，块内并行扫描（并查集只在块内合并，互不干扰）
+    const int chunks = resolveThreads(threads, runs.size(), kMinRunsPerThread);
+    std::vector<int> bounds(chunks + 1, n);
+    bounds[0] = 0;
+    for (int c = 1; c < chunks; ++c) {
+        int b = std::max(bounds[c - 1], static_cast<int>(static_cast<int64_t>(n) * c / chunks));
+        while (b > 0 && b < n && runs[b].row == runs[b - 1].row) {
+            ++b;
+        }
+        bounds[c] = b;
+    }
+    parallelChunks(chunks, [&](int c) {
+        labelRange(runs, bounds[c], bounds[c + 1], k, parent);
+    });
+
+    // 块边界：上一块最后一行与下一块第一行串行合并
+    for (int c = 1; c < chunks; ++c) {
+        const int b = bounds[c];
+        if (b <= 0 || b >= n || runs[b].row != runs[b - 1].row + 1) {
+            continue;
+        }
+        int prevBegin = b - 1;
+        while (prevBegin > 0 && runs[prevBegin - 1].row == runs[b - 1].row) {
+            --prevBegin;
+        }
+        int curEnd = b;
+        while (curEnd < n && runs[curEnd].row == runs[b].row) {
+            ++curEnd;
+        }
+        linkRows(runs, prevBegin, b, b, curEnd, k, parent);
+    }
+
+    labels->assign(n, -1);
+    std::vector<int> rootLabel(n, -1);
+    int count = 0;
+    for (int r = 0; r < n; ++r) {
+        const int root = findRoot(parent, r);
+        if (rootLabel[root] < 0) {
+            rootLabel[root] = count++;
+        }
+        (*labels)[r] = rootLabel[root];
+    }
+    return count;
+}
+
+std::vector<RleRegion> connection(const RleRegion& region, int neighborhood)
+{
+    const std::vector<RleRun>& runs = region.runs();
+    std::vector<int> labels;
+    const int count = labelRuns(runs, neighborhood, &labels);
+    std::vector<std::vector<RleRun>> parts(count);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        parts[labels[i]].push_back(runs[i]);
+    }
+    std::vector<RleRegion> regions;
+    regions.reserve(count);
+    for (auto& p : parts) {
+        regions.push_back(RleRegion::fromNormalized(std::move(p)));
+    }
+    return regions;
+}
+
+std::vector<RleRegion> selectArea(const std::vector<RleRegion>& regions, int64_t minArea, int64_t maxArea)
+{
+    std::vector<RleRegion> selected;
+    for (const auto& r : regions) {
+        const int64_t a = r.area();
+        if (a >= minArea && a <= maxArea) {
+            selected.push_back(r);
+        }
+    }
+    return selected;
+}
+
+std::vector<RleRegion> selectMaxArea(const std::vector<RleRegion>& regions)
+{
+    std::vector<RleRegion> selected;
+    int64_t best = -1;
+    size_t bestIdx = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        const int64_t a = regions[i].area();
+        if (a > best) {
+            best = a;
+            bestIdx = i;
+        }
+    }
+    if (best >= 0) {
+        selected.push_back(regions[bestIdx]);
+    }
+    return selected;
+}
+
+RleRegion union1(const std::vector<RleRegion>& regions)
+{
+    std::vector<RleRun> runs;
+    size_t total = 0;
+    for (const auto& r : regions) {
+        total += r.runCount();
+    }
+    runs.reserve(total);
+    for (const auto& r : regions) {
+        runs.insert(runs.end(), r.runs().begin(), r.runs().end());
+    }
+    return RleRegion(std::move(runs));
+}
+
+RleRegion union2(const RleRegion& a, const RleRegion& b)
+{
+    // 两个有序序列按(行, 列)归并后逐行合并
+    const auto& ra = a.runs();
+    const auto& rb = b.runs();
+    std::vector<RleRun> merged(ra.size() + rb.size());
+    std::merge(ra.begin(), ra.end(), rb.begin(), rb.end(), merged.begin(), [](const RleRun& x, const RleRun& y) {
+        return x.row < y.row || (x.row == y.row && x.colBegin < y.colBegin);
+    });
+    std::vector<RleRun> out;
+    out.reserve(merged.size());
+    size_t i = 0;
+    while (i < merged.size()) {
+        size_t j = i;
+        while (j < merged.size() && merged[j].row == merged[i].row) {
+            ++j;
+        }
+        appendMergedRow(merged.data() + i, merged.data() + j, &out);
+        i = j;
+    }
+    return RleRegion::fromNormalized(std::move(out));
+}
+
+RleRegion intersection(const RleRegion& a, const RleRegion& b)
+{
+    const auto& ra = a.runs();
+    const auto& rb = b.runs();
+    std::vector<RleRun> out;
+    size_t i = 0, j = 0;
+    while (i < ra.size() && j < rb.size()) {
+        if (ra[i].row != rb[j].row) {
+            if (ra[i].row < rb[j].row) {
+                ++i;
+            }
+            else {
+                ++j;
+            }
+            continue;
+        }
+        const int lo = std::max(ra[i].colBegin, rb[j].colBegin);
+        const int hi = std::min(ra[i].colEnd, rb[j].colEnd);
+        if (lo <= hi) {
+            out.push_back({ ra[i].row, lo, hi });
+        }
+        if (ra[i].colEnd < rb[j].colEnd) {
+            ++i;
+        }
+        else {
+            ++j;
+        }
+    }
+    return RleRegion::fromNormalized(std::move(out));
+}
+
+RleRegion difference(const RleRegion& a, const RleRegion& b)
+{
+    const auto& ra = a.runs();
+    const auto& rb = b.runs();
+    std::vector<RleRun> out;
+    size_t j = 0;
+    for (const auto& r : ra) {
+        while (j < rb.size() && (rb[j].row < r.row || (rb[j].row == r.row && rb[j].colEnd < r.colBegin))) {
+            ++j;
+        }
+        int start = r.colBegin;
+        size_t k = j;
+        while (k < rb.size() && rb[k].row == r.row && rb[k].colBegin <= r.colEnd) {
+            if (rb[k].colBegin > start) {
+                out.push_back({ r.row, start, rb[k].colBegin - 1 });
+            }
+            start = std::max(start, rb[k].colEnd + 1);
+            ++k;
+        }
+        if (start <= r.colEnd) {
+            out.push_back({ r.row, start, r.colEnd });
+        }
+    }
+    return RleRegion::fromNormalized(std::move(out));
+}
+
+RleRegion clip(const RleRegion& region, int width, int height)
+{
+    std::vector<RleRun> out;
+    out.reserve(region.runCount());
+    for (const auto& r : region.runs()) {
+        if (r.row < 0 || r.row >= height) {
+            continue;
+        }
+        const int cb = std::max(0, static_cast<int>(r.colBegin));
+        const int ce = std::min(width - 1, static_cast<int>(r.colEnd));
+        if (cb <= ce) {
+            out.push_back({ r.row, cb, ce });
+        }
+    }
+    return RleRegion::fromNormalized(std::move(out));
+}
+
+RleRegion fillUp(const RleRegion& region)
+{
+    int row1, col1, row2, col2;
+    if (!region.boundingBox(&row1, &col1, &row2, &col2)) {
+        return region;
+    }
+    // 外接矩形内的背景游程
+    const auto& runs = region.runs();
+    std::vector<RleRun> background;
+    size_t i = 0;
+    for (int y = row1; y <= row2; ++y) {
+        int start = col1;
+        while (i < runs.size() && runs[i].row == y) {
+            if (runs[i].colBegin > start) {
+                background.push_back({ y, start, runs[i].colBegin - 1 });
+            }
+            start = runs[i].colEnd + 1;
+            ++i;
+        }
+        if (start <= col2) {
+            background.push_back({ y, start, col2 });
+        }
+    }
+    std::vector<int> labels;
+    const int count = labelRuns(background, 4, &labels);
+    // 与外接矩形边界相接的背景属于外部
+    std::vector<char> exterior(count, 0);
+    for (size_t k = 0; k < background.size(); ++k) {
+        const RleRun& r = background[k];
+        if (r.row == row1 || r.row == row2 || r.colBegin == col1 || r.colEnd == col2) {
+            exterior[labels[k]] = 1;
+        }
+    }
+    std::vector<RleRun> holes;
+    for (size_t k = 0; k < background.size(); ++k) {
+        if (!exterior[labels[k]]) {
+            holes.push_back(background[k]);
+        }
+    }
+    if (holes.empty()) {
+        return region;
+    }
+    return union2(region, RleRegion::fromNormalized(std::move(holes)));
+}
+
+RleRegion dilationCircle(const RleRegion& region, double radius, int threads)
+{
+    const std::vector<int> hw = circleHalfWidths(radius);
+    if (region.empty() || hw.empty()) {
+        return region;
+    }
+    const int r = static_cast<int>(hw.size()) - 1;
+    const RowIndex index(region.runs());
+    const int first = index.top - r;
+    const int rows = index.bottom + r - first + 1;
+    const int chunks = resolveThreads(threads, rows, kMinRowsPerThread);
+    std::vector<std::vector<RleRun>> parts(chunks);
+    parallelChunks(chunks, [&](int k) {
+        const int yBegin = first + rows * k / chunks;
+        const int yEnd = first + rows * (k + 1) / chunks;
+        const RleRun* src = region.runs().data();
+        std::vector<RleRun> rowRuns;
+        for (int y = yBegin; y < yEnd; ++y) {
+            // 第y行 = 各源行游程按该行结构元素半宽扩展后的并集
+            rowRuns.clear();
+            for (int dy = -r; dy <= r; ++dy) {
+                size_t b, e;
+                index.row(y + dy, &b, &e);
+                const int w = hw[std::abs(dy)];
+                for (size_t i = b; i < e; ++i) {
+                    rowRuns.push_back({ y, src[i].colBegin - w, src[i].colEnd + w });
+                }
+            }
+            std::sort(rowRuns.begin(), rowRuns.end(), [](const RleRun& x, const RleRun& z) {
+                return x.colBegin < z.colBegin;
+            });
+            appendMergedRow(rowRuns.data(), rowRuns.data() + rowRuns.size(), &parts[k]);
+        }
+    });
+    return RleRegion::fromNormalized(concatParts(parts));
+}
+
+RleRegion erosionCircle(const RleRegion& region, double radius, int threads)
+{
+    const std::vector<int> hw = circleHalfWidths(radius);
+    if (region.empty() || hw.empty()) {
+        return region;
+    }
+    const int r = static_cast<int>(hw.size()) - 1;
+    const RowIndex index(region.runs());
+    const int first = index.top + r;
+    const int rows = index.bottom - r - first + 1;
+    if (rows <= 0) {
+        return RleRegion();
+    }
+    const int chunks = resolveThreads(threads, rows, kMinRowsPerThread);
+    std::vector<std::vector<RleRun>> parts(chunks);
+    parallelChunks(chunks, [&](int k) {
+        const int yBegin = first + rows * k / chunks;
+        const int yEnd = first + rows * (k + 1) / chunks;
+        const RleRun* src = region.runs().data();
+        std::vector<RleRun> cur, tmp;
+        for (int y = yBegin; y < yEnd; ++y) {
+            // 第y行 = 各源行游程按该行结构元素半宽收缩后的交集
+            size_t b, e;
+            index.row(y, &b, &e);
+            cur.clear();
+            for (size_t i = b; i < e; ++i) {
+                if (src[i].colBegin + hw[0] <= src[i].colEnd - hw[0]) {
+                    cur.push_back({ y, src[i].colBegin + hw[0], src[i].colEnd - hw[0] });
+                }
+            }
+            for (int dy = 1; dy <= r && !cur.empty(); ++dy) {
+                for (int s = -1; s <= 1 && !cur.empty(); s += 2) {
+                    index.row(y + s * dy, &b, &e);
+                    intersectRow(cur, src + b, src + e, hw[dy], &tmp);
+                    cur.swap(tmp);
+                }
+            }
+            parts[k].insert(parts[k].end(), cur.begin(), cur.end());
+        }
+    });
+    return RleRegion::fromNormalized(concatParts(parts));
+}
+
+RleRegion openingCircle(const RleRegion& region, double radius, int threads)
+{
+    return dilationCircle(erosionCircle(region, radius, threads), radius, threads);
+}
+
+RleRegion closingCircle(const RleRegion& region, double radius, int threads)
+{
+    return erosionCircle(dilationCircle(region, radius, threads), radius, threads);
+}
+
+std::vector<RleRegion> openingCircle(const std::vector<RleRegion>& regions, double radius, int threads)
+{
+    std::vector<RleRegion> out(regions.size());
+    size_t totalRuns = 0;
+    for (const auto& r : regions) {
+        totalRuns += r.runCount();
+    }
+    // 区域之间并行，单个区域内部串行
+    const int chunks = std::min<int>(static_cast<int>(regions.size()),
+        resolveThreads(threads, totalRuns, kMinRunsPerThread));
+    parallelChunks(std::max(chunks, 1), [&](int k) {
+        for (size_t i = k; i < regions.size(); i += std::max(chunks, 1)) {
+            out[i] = openingCircle(regions[i], radius, 1);
+        }
+    });
+    return out;
+}
+
+} // namespace RleOps
+
+// ========================== 连通域特征 ===================== //
+namespace {
+
+double cross(const RlePoint& o, const RlePoint& a, const RlePoint& b)
+{
+    return (a.col - o.col) * (b.row - o.row) - (a.row - o.row) * (b.col - o.col);
+}
+
+// 单调链凸包，points按(col, row)排序后原地使用；结果在(col, row)坐标系下逆时针，不含共线点
+std::vector<RlePoint> convexHull(std::vector<RlePoint>& points)
+{
+    std::sort(points.begin(), points.end(), [](const RlePoint& a, const RlePoint& b) {
+        return a.col < b.col || (a.col == b.col && a.row < b.row);
+    });
+    const size_t n = points.size();
+    if (n < 3) {
+        return points;
+    }
+    std::vector<RlePoint> hull(2 * n);
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+            --k;
+        }
+        hull[k++] = points[i];
+    }
+    for (size_t i = n - 1, t = k + 1; i > 0; --i) {
+        while (k >= t && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) {
+            --k;
+        }
+        hull[k++] = points[i - 1];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
+
+// 一个连通域（游程按行、列升序）的全部特征，单次遍历游程
+RleComponent describeRuns(const RleRun* runs, size_t count)
+{
+    RleComponent c;
+    if (count == 0) {
+        return c;
+    }
+    c.row1 = runs[0].row;
+    c.row2 = runs[count - 1].row;
+    c.col1 = runs[0].colBegin;
+    c.col2 = runs[0].colEnd;
+    for (size_t i = 0; i < count; ++i) {
+        c.col1 = std::min(c.col1, static_cast<int>(runs[i].colBegin));
+        c.col2 = std::max(c.col2, static_cast<int>(runs[i].colEnd));
+    }
+
+    // 坐标平移到外接矩形左上角再累加，保证矩的数值精度
+    double sr = 0.0, sc = 0.0, srr = 0.0, scc = 0.0, src = 0.0;
+    std::vector<RlePoint> ends;
+    ends.reserve(2 * static_cast<size_t>(c.row2 - c.row1 + 1));
+    size_t i = 0;
+    while (i < count) {
+        const int y = runs[i].row;
+        const double ry = y - c.row1;
+        const int rowBegin = runs[i].colBegin;
+        int rowEnd = runs[i].colEnd;
+        for (; i < count && runs[i].row == y; ++i) {
+            const double a = runs[i].colBegin - c.col1;
+            const double b = runs[i].colEnd - c.col1;
+            const double n = b - a + 1.0;
+            // sum(c) 与 sum(c^2)，c取[a, b]
+            const double s1 = (a + b) * n * 0.5;
+            const double s2 = (b * (b + 1.0) * (2.0 * b + 1.0) - (a - 1.0) * a * (2.0 * a - 1.0)) / 6.0;
+            c.area += static_cast<int64_t>(n);
+            sr += ry * n;
+            srr += ry * ry * n;
+            sc += s1;
+            scc += s2;
+            src += ry * s1;
+            rowEnd = runs[i].colEnd;
+        }
+        // 每行只有最左、最右两端的像素中心可能在凸包上（与SmallestRectangle2一致按像素中心计算）
+        ends.push_back({ static_cast<double>(y), static_cast<double>(rowBegin) });
+        if (rowEnd != rowBegin) {
+            ends.push_back({ static_cast<double>(y), static_cast<double>(rowEnd) });
+        }
+    }
+    const double area = static_cast<double>(c.area);
+    const double mr = sr / area;
+    const double mc = sc / area;
+    c.row = c.row1 + mr;
+    c.col = c.col1 + mc;
+    c.m20 = srr / area - mr * mr;
+    c.m02 = scc / area - mc * mc;
+    c.m11 = src / area - mr * mc;
+
+    c.hull = convexHull(ends);
+    c.rect = RleComponents::smallestRectangle2(c.hull);
+    const double rectArea = 4.0 * c.rect.length1 * c.rect.length2;
+    c.fillRatio = rectArea > 0.0 ? area / rectArea : 0.0;
+    return c;
+}
+
+} // namespace
+
+RleRect2 RleComponents::smallestRectangle2(const std::vector<RlePoint>& hull)
+{
+    RleRect2 best;
+    const size_t n = hull.size();
+    if (n == 0) {
+        return best;
+    }
+    const double pi = 3.14159265358979323846;
+    if (n < 3) {
+        // 单个像素或共线（单行/单列/斜线）区域：退化为线段，length2为0
+        const RlePoint& p = hull[0];
+        const RlePoint& q = hull[n - 1];
+        best.row = 0.5 * (p.row + q.row);
+        best.col = 0.5 * (p.col + q.col);
+        best.length1 = 0.5 * std::hypot(q.row - p.row, q.col - p.col);
+        if (best.length1 > 0.0) {
+            double phi = std::atan2(-(q.row - p.row), q.col - p.col);
+            if (phi <= -pi / 2) phi += pi;
+            if (phi > pi / 2) phi -= pi;
+            best.phi = phi;
+        }
+        return best;
+    }
+    auto dot = [](double ax, double ay, double bx, double by) { return ax * bx + ay * by; };
+    double bestArea = -1.0;
+    // 三个卡壳指针：沿边方向最远(right)、最近(left)，沿内法向最远(top)，随边的旋转单调前进
+    size_t right = 0, left = 0, top = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const RlePoint& p = hull[i];
+        const RlePoint& q = hull[(i + 1) % n];
+        double ux = q.col - p.col, uy = q.row - p.row;
+        const double len = std::sqrt(ux * ux + uy * uy);
+        if (len <= 0.0) {
+            continue;
+        }
+        ux /= len;
+        uy /= len;
+        // (col, row)坐标系下逆时针，内侧在边的左侧
+        const double nx = -uy, ny = ux;
+        auto projU = [&](size_t k) { return dot(hull[k].col - p.col, hull[k].row - p.row, ux, uy); };
+        auto projN = [&](size_t k) { return dot(hull[k].col - p.col, hull[k].row - p.row, nx, ny); };
+        if (bestArea < 0.0) {
+            for (size_t k = 0; k < n; ++k) {
+                if (projU(k) > projU(right)) right = k;
+                if (projU(k) < projU(left)) left = k;
+                if (projN(k) > projN(top)) top = k;
+            }
+        }
+        else {
+            for (size_t s = 0; s < n && projU((right + 1) % n) >= projU(right); ++s) right = (right + 1) % n;
+            for (size_t s = 0; s < n && projN((top + 1) % n) >= projN(top); ++s) top = (top + 1) % n;
+            for (size_t s = 0; s < n && projU((left + 1) % n) <= projU(left); ++s) left = (left + 1) % n;
+        }
+        const double uMax = projU(right), uMin = projU(left), h = projN(top);
+        const double area = (uMax - uMin) * h;
+        if (bestArea < 0.0 || area < bestArea) {
+            bestArea = area;
+            const double cu = 0.5 * (uMax + uMin), cn = 0.5 * h;
+            best.col = p.col + ux * cu + nx * cn;
+            best.row = p.row + uy * cu + ny * cn;
+            double w = 0.5 * (uMax - uMin), hh = 0.5 * h;
+            // 长轴方向：沿边(u)或沿法向(n)
+            double ax = ux, ay = uy;
+            if (hh > w) {
+                std::swap(w, hh);
+                ax = nx;
+                ay = ny;
+            }
+            best.length1 = w;
+            best.length2 = hh;
+            // Halcon角度：列轴逆时针为正（行向下，取-row）
+            double phi = std::atan2(-ay, ax);
+            if (phi <= -pi / 2) phi += pi;
+            if (phi > pi / 2) phi -= pi;
+            best.phi = phi;
+        }
+    }
+    return best;
+}
+
+RleComponents RleComponents::label(const RleRegion& region, int neighborhood, int threads)
+{
+    RleComponents result;
+    const std::vector<RleRun>& runs = region.runs();
+    std::vector<int> labels;
+    const int count = RleOps::labelRuns(runs, neighborhood, &labels, threads);
+
+    // 计数排序按连通域分组（稳定，组内仍按行、列升序）
+    result.offsets_.assign(static_cast<size_t>(count) + 1, 0);
+    for (int l : labels) {
+        ++result.offsets_[l + 1];
+    }
+    for (int c = 0; c < count; ++c) {
+        result.offsets_[c + 1] += result.offsets_[c];
+    }
+    result.runs_.resize(runs.size());
+    std::vector<size_t> cursor(result.offsets_.begin(), result.offsets_.end() - 1);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        result.runs_[cursor[labels[i]]++] = runs[i];
+    }
+
+    // 特征：按游程数均衡分块，连通域之间并行
+    result.comps_.resize(count);
+    const int chunks = std::min(std::max(count, 1), resolveThreads(threads, runs.size(), kMinRunsPerThread));
+    std::vector<int> bounds(chunks + 1, count);
+    bounds[0] = 0;
+    for (int k = 1, c = 0; k < chunks; ++k) {
+        const size_t target = runs.size() * k / chunks;
+        while (c < count && result.offsets_[c] < target) {
+            ++c;
+        }
+        bounds[k] = c;
+    }
+    parallelChunks(chunks, [&](int k) {
+        for (int c = bounds[k]; c < bounds[k + 1]; ++c) {
+            result.comps_[c] = describeRuns(result.runs_.data() + result.offsets_[c],
+                result.offsets_[c + 1] - result.offsets_[c]);
+        }
+    });
+    return result;
+}
+
+RleComponent RleComponents::describe(const RleRegion& region)
+{
+    return describeRuns(region.runs().data(), region.runCount());
+}
+
+RleRegion RleComponents::region(size_t i) const
+{
+    return RleRegion::fromNormalized(std::vector<RleRun>(runs_.begin() + offsets_[i], runs_.begin() + offsets_[i + 1]));
+}
+
+int RleComponents::indexOfMaxArea() const
+{
+    int best = -1;
+    for (size_t i = 0; i < comps_.size(); ++i) {
+        if (best < 0 || comps_[i].area > comps_[best].area) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+std::vector<size_t> RleComponents::selectArea(int64_t minArea, int64_t maxArea) const
+{
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < comps_.size(); ++i) {
+        if (comps_[i].area >= minArea && comps_[i].area <= maxArea) {
+            selected.push_back(i);
+        }
+    }
+    return selected;
+}
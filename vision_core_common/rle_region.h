@@ -0,0 +1,163 @@
+﻿#ifndef RLE_REGION_H
+#define RLE_REGION_H
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef USE_HALCON
+#define NOMINMAX
+#include <halconCpp/HalconCpp.h>
+#endif
+
+
+/*
+    原生游程编码区域库 ---- 长度类插件(毛羽布料、PWP)的区域运算后端，核心部分不依赖Halcon
+    1. 区域按行存储游程[colBegin, colEnd]（闭区间，与GetRegionRuns一致），按行、列升序排列，
+       同一行内游程互不重叠也不相接（规范化）
+    2. 算子语义与Halcon对应算子一致：Threshold、Connection(8邻域)、SelectShape(area)、
+       SelectShapeStd(max_area)、FillUp、Erosion/Dilation/Opening/ClosingCircle、Union1/Union2/Intersection/Difference
+       圆形结构元素为 dx^2 + dy^2 <= r^2 的离散圆（半径1.5为3x3）
+    3. 阈值按游程、形态学按输出行分块多线程执行，threads <= 0 时取硬件线程数，数据量小时自动单线程
+    4. RleComponents一次标记得到各连通域的面积、外接矩形、重心、二阶矩、凸包、最小外接矩形(旋转卡壳)和填充率，
+       后续筛选和模式判定只需查表
+    定义USE_HALCON时提供与HObject区域的互转
+*/
+struct RleRun {
+    int32_t row;
+    int32_t colBegin;
+    int32_t colEnd;
+};
+
+class RleRegion
+{
+public:
+    RleRegion() = default;
+    // 由任意顺序的游程构造（内部排序并合并重叠/相接的游程）
+    explicit RleRegion(std::vector<RleRun> runs);
+    // 由已规范化的游程构造（不再检查）
+    static RleRegion fromNormalized(std::vector<RleRun> runs);
+
+    const std::vector<RleRun>& runs() const { return runs_; }
+    bool empty() const { return runs_.empty(); }
+    size_t runCount() const { return runs_.size(); }
+    int64_t area() const;
+    // 外接矩形（闭区间），空区域返回false
+    bool boundingBox(int* row1, int* col1, int* row2, int* col2) const;
+
+    static RleRegion rectangle1(int row1, int col1, int row2, int col2);
+
+#ifdef USE_HALCON
+    // 多个区域对象时取并集
+    static RleRegion fromHObject(const HalconCpp::HObject& region);
+    HalconCpp::HObject toHObject() const;
+    // 区域集合转换为Halcon对象元组（顺序不变）
+    static HalconCpp::HObject toHObject(const std::vector<RleRegion>& regions);
+#endif
+
+private:
+    std::vector<RleRun> runs_;
+};
+
+namespace RleOps
+{
+    // domain内灰度在[minGray, maxGray]的像素，image为8位单通道图像，domain裁剪到图像内
+    RleRegion threshold(const uint8_t* image, int width, int height, int stride, const RleRegion& domain,
+        int minGray, int maxGray, int threads = 0);
+
+    // 游程连通标记：按行分块并行扫描 + 块边界串行合并的并查集
+    // labels[i]为第i个游程的连通域编号（按首个游程的位置从0编号），返回连通域个数
+    int labelRuns(const std::vector<RleRun>& runs, int neighborhood, std::vector<int>* labels, int threads = 0);
+    // 连通域（neighborhood为4或8），按区域首个游程的位置（先行后列）排序
+    std::vector<RleRegion> connection(const RleRegion& region, int neighborhood = 8);
+    // SelectShape(..., "area", "and", minArea, maxArea)
+    std::vector<RleRegion> selectArea(const std::vector<RleRegion>& regions, int64_t minArea, int64_t maxArea);
+    // SelectShapeStd(..., "max_area", ...)：面积最大的一个区域（并列取靠前者），输入为空时返回空集合
+    std::vector<RleRegion> selectMaxArea(const std::vector<RleRegion>& regions);
+
+    RleRegion union1(const std::vector<RleRegion>& regions);
+    RleRegion union2(const RleRegion& a, const RleRegion& b);
+    RleRegion intersection(const RleRegion& a, const RleRegion& b);
+    RleRegion difference(const RleRegion& a, const RleRegion& b);
+    // 裁剪到[0, width) x [0, height)
+    RleRegion clip(const RleRegion& region, int width, int height);
+
+    // 填充孔洞（背景按4邻域，不与外接矩形边界连通的背景即为孔洞）
+    RleRegion fillUp(const RleRegion& region);
+
+    RleRegion dilationCircle(const RleRegion& region, double radius, int threads = 0);
+    RleRegion erosionCircle(const RleRegion& region, double radius, int threads = 0);
+    RleRegion openingCircle(const RleRegion& region, double radius, int threads = 0);
+    RleRegion closingCircle(const RleRegion& region, double radius, int threads = 0);
+    // 区域集合逐个开运算（与Halcon对对象元组的语义一致），区域之间并行
+    std::vector<RleRegion> openingCircle(const std::vector<RleRegion>& regions, double radius, int threads = 0);
+}
+
+// 连通域特征
+struct RlePoint {
+    double row;
+    double col;
+};
+
+// 任意方向矩形，参数含义与SmallestRectangle2一致（phi为长轴方向，弧度，范围(-pi/2, pi/2]）
+struct RleRect2 {
+    double row = 0.0;
+    double col = 0.0;
+    double phi = 0.0;
+    double length1 = 0.0;
+    double length2 = 0.0;
+};
+
+struct RleComponent {
+    int64_t area = 0;
+    // 外接矩形（闭区间）
+    int row1 = 0;
+    int col1 = 0;
+    int row2 = -1;
+    int col2 = -1;
+    // 重心（像素中心）
+    double row = 0.0;
+    double col = 0.0;
+    // 按面积归一化的中心二阶矩：m20为行方向，m02为列方向
+    double m20 = 0.0;
+    double m02 = 0.0;
+    double m11 = 0.0;
+    // 凸包（像素中心，逆时针）
+    std::vector<RlePoint> hull;
+    // 最小外接矩形（按像素中心，与SmallestRectangle2一致：10x100的矩形区域length1=49.5, length2=4.5）
+    RleRect2 rect;
+    // area / (4 * length1 * length2)
+    double fillRatio = 0.0;
+};
+
+class RleComponents
+{
+public:
+    RleComponents() = default;
+
+    // 连通域标记 + 特征，连通域顺序与RleOps::connection一致；特征按连通域并行计算
+    static RleComponents label(const RleRegion& region, int neighborhood = 8, int threads = 0);
+    // 整个区域（不区分连通性）作为一个对象的特征，对应Halcon对单个区域对象调用AreaCenter/SmallestRectangle2
+    static RleComponent describe(const RleRegion& region);
+    // 凸包（逆时针）的最小面积外接矩形，旋转卡壳O(n)
+    static RleRect2 smallestRectangle2(const std::vector<RlePoint>& hull);
+
+    size_t size() const { return comps_.size(); }
+    bool empty() const { return comps_.empty(); }
+    const RleComponent& operator[](size_t i) const { return comps_[i]; }
+    const std::vector<RleComponent>& components() const { return comps_; }
+    // 第i个连通域的区域
+    RleRegion region(size_t i) const;
+
+    // 面积最大的连通域（并列取靠前者），为空时返回-1
+    int indexOfMaxArea() const;
+    // 面积在[minArea, maxArea]内的连通域编号
+    std::vector<size_t> selectArea(int64_t minArea, int64_t maxArea) const;
+
+private:
+    // 按连通域分组后的游程，第i个连通域为[offsets_[i], offsets_[i + 1])
+    std::vector<RleRun> runs_;
+    std::vector<size_t> offsets_;
+    std::vector<RleComponent> comps_;
+};
+
+#endif // RLE_REGION_H
@@ -0,0 +1,227 @@
+﻿#include "roi_alignment.h"
+#include <QVariantList>
+#include <QVariantMap>
+#include <cmath>
+
+using namespace HalconCpp;
+
+namespace {
+    // 由位姿构造刚体变换 (row, col) -> (row', col')，与VectorAngleToRigid(0, 0, 0, row, col, angle)一致
+    void rigidFromPose(double row, double col, double angle, double h[6])
+    {
+        double c = std::cos(angle);
+        double s = std::sin(angle);
+        h[0] = c; h[1] = -s; h[2] = row;
+        h[3] = s; h[4] = c;  h[5] = col;
+    }
+
+    // 刚体/仿射变换求逆
+    bool invertAffine(const double h[6], double inv[6])
+    {
+        double det = h[0] * h[4] - h[1] * h[3];
+        if (std::abs(det) < 1e-12) {
+            return false;
+        }
+        inv[0] = h[4] / det;
+        inv[1] = -h[1] / det;
+        inv[3] = -h[3] / det;
+        inv[4] = h[0] / det;
+        inv[2] = -(inv[0] * h[2] + inv[1] * h[5]);
+        inv[5] = -(inv[3] * h[2] + inv[4] * h[5]);
+        return true;
+    }
+
+    // 组合变换 out = a * b（先b后a）
+    void composeAffine(const double a[6], const double b[6], double out[6])
+    {
+        out[0] = a[0] * b[0] + a[1] * b[3];
+        out[1] = a[0] * b[1] + a[1] * b[4];
+        out[2] = a[0] * b[2] + a[1] * b[5] + a[2];
+        out[3] = a[3] * b[0] + a[4] * b[3];
+        out[4] = a[3] * b[1] + a[4] * b[4];
+        out[5] = a[3] * b[2] + a[4] * b[5] + a[5];
+    }
+
+    // 读取6个double的齐次矩阵
+    bool homFromVariant(const QVariant& data, double h[6])
+    {
+        QVariantList list = data.toList();
+        if (list.size() < 6) {
+            return false;
+        }
+        for (int i = 0; i < 6; i++) {
+            bool ok = false;
+            h[i] = list[i].toDouble(&ok);
+            if (!ok || !std::isfinite(h[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+RoiAlignment::RoiAlignment() :
+    identity_(true)
+{
+    h_[0] = 1.0; h_[1] = 0.0; h_[2] = 0.0;
+    h_[3] = 0.0; h_[4] = 1.0; h_[5] = 0.0;
+}
+
+RoiAlignment RoiAlignment::fromPoses(double refRow, double refCol, double refAngle, double row, double col, double angle)
+{
+    double ref[6], cur[6], refInv[6];
+    rigidFromPose(refRow, refCol, refAngle, ref);
+    rigidFromPose(row, col, angle, cur);
+    RoiAlignment alignment;
+    if (!invertAffine(ref, refInv)) {
+        return alignment;
+    }
+    composeAffine(cur, refInv, alignment.h_);
+    alignment.identity_ = false;
+    return alignment;
+}
+
+RoiAlignment RoiAlignment::fromHomography(const HTuple& refHomMat2D, const HTuple& curHomMat2D)
+{
+    RoiAlignment alignment;
+    if (refHomMat2D.Length() < 6 || curHomMat2D.Length() < 6) {
+        return alignment;
+    }
+    double ref[6], cur[6], refInv[6];
+    for (int i = 0; i < 6; i++) {
+        ref[i] = refHomMat2D[i].D();
+        cur[i] = curHomMat2D[i].D();
+    }
+    if (!invertAffine(ref, refInv)) {
+        return alignment;
+    }
+    composeAffine(cur, refInv, alignment.h_);
+    alignment.identity_ = false;
+    return alignment;
+}
+
+QString RoiAlignment::contextKey()
+{
+    return QStringLiteral("roi_alignment");
+}
+
+RoiAlignment RoiAlignment::fromVariant(const QVariant& data)
+{
+    RoiAlignment alignment;
+    QVariantMap map = data.toMap();
+    if (map.isEmpty()) {
+        return alignment;
+    }
+
+    double ref[6], cur[6], refInv[6];
+    if (map.contains("homography")) {
+        if (!homFromVariant(map.value("homography"), cur) || !homFromVariant(map.value("ref_homography"), ref)) {
+            return alignment;
+        }
+    } else {
+        static const char* keys[6] = { "ref_row", "ref_col", "ref_angle", "row", "col", "angle" };
+        double pose[6];
+        for (int i = 0; i < 6; i++) {
+            bool ok = false;
+            pose[i] = map.value(keys[i]).toDouble(&ok);
+            if (!ok || !std::isfinite(pose[i])) {
+                return alignment;
+            }
+        }
+        rigidFromPose(pose[0], pose[1], pose[2], ref);
+        rigidFromPose(pose[3], pose[4], pose[5], cur);
+    }
+    if (!invertAffine(ref, refInv)) {
+        return alignment;
+    }
+    composeAffine(cur, refInv, alignment.h_);
+    alignment.identity_ = false;
+    return alignment;
+}
+
+QVariant RoiAlignment::poseToVariant(double refRow, double refCol, double refAngle, double row, double col, double angle)
+{
+    QVariantMap map;
+    map.insert("ref_row", refRow);
+    map.insert("ref_col", refCol);
+    map.insert("ref_angle", refAngle);
+    map.insert("row", row);
+    map.insert("col", col);
+    map.insert("angle", angle);
+    return map;
+}
+
+bool RoiAlignment::isIdentity() const
+{
+    return identity_;
+}
+
+QPointF RoiAlignment::mapPoint(const QPointF& pt) const
+{
+    double x = 0.0, y = 0.0;
+    mapPoint(pt.x(), pt.y(), x, y);
+    return QPointF(x, y);
+}
+
+void RoiAlignment::mapPoint(double x, double y, double& outX, double& outY) const
+{
+    if (identity_) {
+        outX = x;
+        outY = y;
+        return;
+    }
+    // ROI坐标 x为列，y为行
+    double row = h_[0] * y + h_[1] * x + h_[2];
+    double col = h_[3] * y + h_[4] * x + h_[5];
+    outX = col;
+    outY = row;
+}
+
+QVector<QPointF> RoiAlignment::mapPolygon(const QVector<QPointF>& pts) const
+{
+    QVector<QPointF> mapped;
+    mapped.reserve(pts.size());
+    for (const auto& pt : pts) {
+        mapped.append(mapPoint(pt));
+    }
+    return mapped;
+}
+
+double RoiAlignment::rotation() const
+{
+    // Halcon角度逆时针为正：h = [cos, -sin; sin, cos]
+    return std::atan2(h_[3], h_[0]);
+}
+
+double RoiAlignment::mapAngleDeg(double angleDeg) const
+{
+    if (identity_) {
+        return angleDeg;
+    }
+    // ROI角度在图像坐标系（行向下）中度量，与Halcon角度符号相反，故减去旋转角
+    double angle = angleDeg - rotation() * 180.0 / 3.14159265358979323846;
+    angle = std::fmod(angle, 360.0);
+    if (angle < 0) {
+        angle += 360.0;
+    }
+    return angle;
+}
+
+HObject RoiAlignment::mapRegion(const HObject& region) const
+{
+    if (identity_) {
+        return region;
+    }
+    HObject mapped;
+    AffineTransRegion(region, &mapped, homMat2D(), "nearest_neighbor");
+    return mapped;
+}
+
+HTuple RoiAlignment::homMat2D() const
+{
+    HTuple homMat;
+    for (int i = 0; i < 6; i++) {
+        homMat.Append(h_[i]);
+    }
+    return homMat;
+}
@@ -0,0 +1,74 @@
+﻿#ifndef ROI_ALIGNMENT_H
+#define ROI_ALIGNMENT_H
+
+#include <QPointF>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#define NOMINMAX
+#include <halconCpp/HalconCpp.h>
+
+/*
+    ROI位姿对齐服务 ---- 根据形状匹配结果的位姿，把模板图像上绘制的ROI变换到当前图像
+    位姿采用Halcon的刚体变换约定（row, col坐标, 弧度），与MatchingResult::homography一致：
+        row' = h0 * row + h1 * col + h2
+        col' = h3 * row + h4 * col + h5
+    ROI绘制在模板图像上，因此对齐变换 = 当前位姿 * 参考位姿的逆
+    流程中由上游匹配步骤把位姿写入AlgorithmContext数据（键为contextKey()），下游插件在run()中读取
+*/
+class RoiAlignment
+{
+public:
+    // 默认构造为单位变换（不对齐）
+    RoiAlignment();
+
+    // 由参考位姿（模板图像中的匹配结果）和当前位姿构造
+    static RoiAlignment fromPoses(double refRow, double refCol, double refAngle,
+        double row, double col, double angle);
+
+    // 由参考和当前的MatchingResult::homography构造
+    static RoiAlignment fromHomography(const HalconCpp::HTuple& refHomMat2D,
+        const HalconCpp::HTuple& curHomMat2D);
+
+    // AlgorithmContext中对齐位姿的数据键
+    static QString contextKey();
+
+    // 由AlgorithmContext数据构造，数据为QVariantMap：
+    //     位姿 {"ref_row","ref_col","ref_angle","row","col","angle"}
+    //     或齐次矩阵 {"ref_homography","homography"}（各6个double）
+    // 数据缺失或无效时返回单位变换
+    static RoiAlignment fromVariant(const QVariant& data);
+
+    // 把参考位姿与当前位姿打包为AlgorithmContext数据（上游匹配步骤使用）
+    static QVariant poseToVariant(double refRow, double refCol, double refAngle,
+        double row, double col, double angle);
+
+    // 是否为单位变换
+    bool isIdentity() const;
+
+    // 变换点（QPointF的x为列，y为行，与ROI坐标一致）
+    QPointF mapPoint(const QPointF& pt) const;
+    void mapPoint(double x, double y, double& outX, double& outY) const;
+
+    // 变换多边形顶点（矩形、多边形ROI）
+    QVector<QPointF> mapPolygon(const QVector<QPointF>& pts) const;
+
+    // 变换角度（度，ROI坐标系即图像行向下的坐标系，与RoiArcRing::startAngle一致）
+    double mapAngleDeg(double angleDeg) const;
+
+    // 旋转角（弧度）
+    double rotation() const;
+
+    // 变换Halcon区域
+    HalconCpp::HObject mapRegion(const HalconCpp::HObject& region) const;
+
+    // 获取Halcon齐次变换矩阵
+    HalconCpp::HTuple homMat2D() const;
+
+private:
+    double h_[6];
+    bool identity_;
+};
+
+#endif // ROI_ALIGNMENT_H
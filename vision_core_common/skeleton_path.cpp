@@ -0,0 +1,433 @@
+﻿#include "skeleton_path.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+
+namespace {
+
+// 少于该行数不拆分线程
+const int kMinRowsPerThread = 32;
+
+// 按位压缩的二值图：外扩1像素边框，第x个像素为words[x / 64]的第(x % 64)位
+struct BitImage {
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    // 原区域坐标 = 位图坐标 + origin - 1
+    int originRow = 0;
+    int originCol = 0;
+    std::vector<uint64_t> bits;
+
+    uint64_t* row(int y) { return bits.data() + static_cast<size_t>(y) * wordsPerRow; }
+    const uint64_t* row(int y) const { return bits.data() + static_cast<size_t>(y) * wordsPerRow; }
+};
+
+BitImage toBitImage(const RleRegion& region)
+{
+    BitImage img;
+    int row1, col1, row2, col2;
+    if (!region.boundingBox(&row1, &col1, &row2, &col2)) {
+        return img;
+    }
+    img.originRow = row1;
+    img.originCol = col1;
+    img.width = col2 - col1 + 3;
+    img.height = row2 - row1 + 3;
+    img.wordsPerRow = (img.width + 63) / 64;
+    img.bits.assign(static_cast<size_t>(img.wordsPerRow) * img.height, 0);
+    for (const auto& r : region.runs()) {
+        uint64_t* w = img.row(r.row - row1 + 1);
+        const int b = r.colBegin - col1 + 1;
+        const int e = r.colEnd - col1 + 1;
+        for (int x = b; x <= e; ) {
+            const int bit = x & 63;
+            const int n = std::min(64 - bit, e - x + 1);
+            const uint64_t mask = (n == 64) ? ~uint64_t(0) : (((uint64_t(1) << n) - 1) << bit);
+            w[x >> 6] |= mask;
+            x += n;
+        }
+    }
+    return img;
+}
+
+RleRegion fromBitImage(const BitImage& img)
+{
+    std::vector<RleRun> runs;
+    for (int y = 0; y < img.height; ++y) {
+        const uint64_t* w = img.row(y);
+        int start = -1;
+        for (int x = 0; x < img.width; ++x) {
+            const bool on = (w[x >> 6] >> (x & 63)) & 1;
+            if (on && start < 0) {
+                start = x;
+            }
+            else if (!on && start >= 0) {
+                runs.push_back({ y + img.originRow - 1, start + img.originCol - 1, x - 1 + img.originCol - 1 });
+                start = -1;
+            }
+        }
+        if (start >= 0) {
+            runs.push_back({ y + img.originRow - 1, start + img.originCol - 1, img.width - 1 + img.originCol - 1 });
+        }
+    }
+    return RleRegion::fromNormalized(std::move(runs));
+}
+
+// 同一行内相邻像素：west为x-1处的值，east为x+1处的值（跨字边界）
+inline uint64_t westOf(const uint64_t* r, int i)
+{
+    return (r[i] << 1) | (i > 0 ? r[i - 1] >> 63 : 0);
+}
+
+inline uint64_t eastOf(const uint64_t* r, int i, int words)
+{
+    return (r[i] >> 1) | (i + 1 < words ? r[i + 1] << 63 : 0);
+}
+
+// Zhang-Suen单次子迭代（位并行）：src -> dst，返回本行是否有像素被删除
+bool thinRow(const BitImage& src, BitImage& dst, int y, bool firstPass)
+{
+    const int words = src.wordsPerRow;
+    const uint64_t* up = src.row(y - 1);
+    const uint64_t* mid = src.row(y);
+    const uint64_t* down = src.row(y + 1);
+    uint64_t* out = dst.row(y);
+    bool changed = false;
+    for (int i = 0; i < words; ++i) {
+        const uint64_t p = mid[i];
+        if (p == 0) {
+            out[i] = 0;
+            continue;
+        }
+        // 邻域按 P2(N), P3(NE), P4(E), P5(SE), P6(S), P7(SW), P8(W), P9(NW) 顺序
+        const uint64_t n = up[i], s = down[i];
+        const uint64_t ne = eastOf(up, i, words), e = eastOf(mid, i, words), se = eastOf(down, i, words);
+        const uint64_t sw = westOf(down, i), w = westOf(mid, i), nw = westOf(up, i);
+        // 8邻域全为前景的像素(B = 8)不可删除，区域内部的字直接跳过
+        const uint64_t candidates = p & ~(n & ne & e & se & s & sw & w & nw);
+        if (candidates == 0) {
+            out[i] = p;
+            continue;
+        }
+        const uint64_t nb[8] = { n, ne, e, se, s, sw, w, nw };
+
+        // B = 邻域前景数(位切片加法)，要求 2 <= B <= 6
+        uint64_t b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+        for (int k = 0; k < 8; ++k) {
+            const uint64_t c0 = b0 & nb[k];
+            b0 ^= nb[k];
+            const uint64_t c1 = b1 & c0;
+            b1 ^= c0;
+            const uint64_t c2 = b2 & c1;
+            b2 ^= c1;
+            b3 |= c2;
+        }
+        const uint64_t countOk = (b3 | b2 | b1) & ~b3 & ~(b2 & b1 & b0);
+
+        // A = 环形序列中0->1跳变数，要求恰好为1
+        uint64_t ones = 0, twos = 0;
+        for (int k = 0; k < 8; ++k) {
+            const uint64_t t = ~nb[k] & nb[(k + 1) & 7];
+            twos |= ones & t;
+            ones |= t;
+        }
+        const uint64_t transitionOk = ones & ~twos;
+
+        const uint64_t cond = firstPass ? ~(n & e & s) & ~(e & s & w) : ~(n & e & w) & ~(n & s & w);
+        const uint64_t del = candidates & countOk & transitionOk & cond;
+        out[i] = p & ~del;
+        changed |= del != 0;
+    }
+    return changed;
+}
+
+int resolveThreads(int threads, int rows)
+{
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    return std::max(1, std::min(std::max(threads, 1), rows / kMinRowsPerThread));
+}
+
+// 路径端点处指向路径外侧的单位切向（取端点与向内第10个点的连线）；点数不足时返回false
+bool endTangent(const std::vector<RlePoint>& path, bool atEnd, double* dr, double* dc)
+{
+    const int n = static_cast<int>(path.size());
+    if (n < 2) {
+        return false;
+    }
+    const int k = std::min(10, n - 1);
+    const RlePoint& tip = atEnd ? path[n - 1] : path[0];
+    const RlePoint& inner = atEnd ? path[n - 1 - k] : path[k];
+    const double r = tip.row - inner.row, c = tip.col - inner.col;
+    const double len = std::hypot(r, c);
+    if (len < 1e-9) {
+        return false;
+    }
+    *dr = r / len;
+    *dc = c / len;
+    return true;
+}
+
+// 端点切向与间隙方向(gr, gc)的夹角是否在maxAngle内；切向无法确定时不限制
+bool directionAccepted(const std::vector<RlePoint>& path, bool atEnd, double gr, double gc, double maxAngle)
+{
+    double dr, dc;
+    if (!endTangent(path, atEnd, &dr, &dc)) {
+        return true;
+    }
+    return std::acos(std::max(-1.0, std::min(1.0, dr * gr + dc * gc))) <= maxAngle;
+}
+
+} // namespace
+
+RleRegion SkeletonPath::thin(const RleRegion& region, int threads)
+{
+    BitImage cur = toBitImage(region);
+    if (cur.bits.empty()) {
+        return RleRegion();
+    }
+    BitImage next = cur;
+    const int rows = cur.height - 2;
+    const int chunks = resolveThreads(threads, rows);
+    // changed[y]：最近一次子迭代第y行有删除；prevChanged为再前一次
+    std::vector<char> changed(cur.height, 1), prevChanged(cur.height, 1), active(cur.height, 0);
+
+    for (int pass = 0; ; ++pass) {
+        const bool firstPass = (pass & 1) == 0;
+        // 邻域在上两次子迭代中都没有变化的行，本次结果与上次同类子迭代相同，不必处理
+        for (int y = 1; y <= rows; ++y) {
+            active[y] = changed[y - 1] | changed[y] | changed[y + 1] |
+                prevChanged[y - 1] | prevChanged[y] | prevChanged[y + 1];
+        }
+        std::swap(prevChanged, changed);
+        std::fill(changed.begin(), changed.end(), 0);
+
+        auto work = [&](int k) {
+            const int yBegin = 1 + rows * k / chunks;
+            const int yEnd = 1 + rows * (k + 1) / chunks;
+            for (int y = yBegin; y < yEnd; ++y) {
+                if (active[y]) {
+                    changed[y] = thinRow(cur, next, y, firstPass);
+                }
+                else {
+                    std::copy(cur.row(y), cur.row(y) + cur.wordsPerRow, next.row(y));
+                }
+            }
+        };
+        if (chunks <= 1) {
+            work(0);
+        }
+        else {
+            std::vector<std::thread> workers;
+            for (int k = 1; k < chunks; ++k) {
+                workers.emplace_back(work, k);
+            }
+            work(0);
+            for (auto& t : workers) {
+                t.join();
+            }
+        }
+        std::swap(cur, next);
+
+        // 两个子迭代都没有删除即收敛
+        bool any = false;
+        for (int y = 1; y <= rows && !any; ++y) {
+            any = changed[y] || prevChanged[y];
+        }
+        if (!any && pass > 0) {
+            break;
+        }
+    }
+    return fromBitImage(cur);
+}
+
+std::vector<RlePoint> SkeletonPath::longestPath(const RleRegion& skeleton)
+{
+    std::vector<RlePoint> path;
+    // 像素编号与坐标索引
+    std::vector<std::pair<int, int>> pixels;
+    std::unordered_map<int64_t, int> index;
+    for (const auto& r : skeleton.runs()) {
+        for (int c = r.colBegin; c <= r.colEnd; ++c) {
+            index.emplace((static_cast<int64_t>(r.row) << 32) | static_cast<uint32_t>(c), static_cast<int>(pixels.size()));
+            pixels.emplace_back(r.row, c);
+        }
+    }
+    const int n = static_cast<int>(pixels.size());
+    if (n == 0) {
+        return path;
+    }
+    if (n == 1) {
+        path.push_back({ static_cast<double>(pixels[0].first), static_cast<double>(pixels[0].second) });
+        return path;
+    }
+
+    std::vector<double> dist(n);
+    std::vector<int> prev(n);
+    const double diag = std::sqrt(2.0);
+    // 单源最短路，返回最远像素
+    auto farthest = [&](int source) {
+        std::fill(dist.begin(), dist.end(), std::numeric_limits<double>::infinity());
+        std::fill(prev.begin(), prev.end(), -1);
+        typedef std::pair<double, int> Item;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        dist[source] = 0.0;
+        queue.push({ 0.0, source });
+        int far = source;
+        while (!queue.empty()) {
+            const Item top = queue.top();
+            queue.pop();
+            const int u = top.second;
+            if (top.first > dist[u]) {
+                continue;
+            }
+            if (dist[u] > dist[far]) {
+                far = u;
+            }
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dy == 0 && dx == 0) {
+                        continue;
+                    }
+                    const int64_t key = (static_cast<int64_t>(pixels[u].first + dy) << 32) |
+                        static_cast<uint32_t>(pixels[u].second + dx);
+                    auto it = index.find(key);
+                    if (it == index.end()) {
+                        continue;
+                    }
+                    const double d = dist[u] + ((dy != 0 && dx != 0) ? diag : 1.0);
+                    if (d < dist[it->second]) {
+                        dist[it->second] = d;
+                        prev[it->second] = u;
+                        queue.push({ d, it->second });
+                    }
+                }
+            }
+        }
+        return far;
+    };
+
+    const int a = farthest(0);
+    const int b = farthest(a);
+    for (int v = b; v >= 0; v = prev[v]) {
+        path.push_back({ static_cast<double>(pixels[v].first), static_cast<double>(pixels[v].second) });
+    }
+    return path;
+}
+
+std::vector<RlePoint> SkeletonPath::smooth(const std::vector<RlePoint>& path, int window)
+{
+    const int n = static_cast<int>(path.size());
+    const int half = std::max(0, window / 2);
+    if (n < 3 || half == 0) {
+        return path;
+    }
+    // 前缀和，窗口内取平均；端点处窗口对称收缩
+    std::vector<double> sr(n + 1, 0.0), sc(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) {
+        sr[i + 1] = sr[i] + path[i].row;
+        sc[i + 1] = sc[i] + path[i].col;
+    }
+    std::vector<RlePoint> out(n);
+    for (int i = 0; i < n; ++i) {
+        const int h = std::min(half, std::min(i, n - 1 - i));
+        const int lo = i - h, hi = i + h + 1;
+        const double cnt = hi - lo;
+        out[i] = { (sr[hi] - sr[lo]) / cnt, (sc[hi] - sc[lo]) / cnt };
+    }
+    return out;
+}
+
+double SkeletonPath::length(const std::vector<RlePoint>& path)
+{
+    double len = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        len += std::hypot(path[i].row - path[i - 1].row, path[i].col - path[i - 1].col);
+    }
+    return len;
+}
+
+std::vector<SkeletonPath::Measurement> SkeletonPath::measure(const RleRegion& region, int smoothWindow, int threads)
+{
+    std::vector<Measurement> results;
+    const RleComponents components = RleComponents::label(thin(region, threads), 8, threads);
+    for (size_t i = 0; i < components.size(); ++i) {
+        Measurement m;
+        m.path = smooth(longestPath(components.region(i)), smoothWindow);
+        m.length = length(m.path);
+        results.push_back(std::move(m));
+    }
+    std::sort(results.begin(), results.end(), [](const Measurement& a, const Measurement& b) {
+        return a.length > b.length;
+    });
+    return results;
+}
+
+std::vector<SkeletonPath::Measurement> SkeletonPath::bridge(std::vector<Measurement> paths, double maxGap, double maxAngle,
+    double maxGapRelative)
+{
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [](const Measurement& m) {
+        return m.path.empty();
+    }), paths.end());
+
+    while (maxGap > 0.0 && paths.size() > 1) {
+        // 搜索最近的合格端点对：(i, endI)为前一段的尾端，(j, endJ)为后一段的首端
+        double best = std::numeric_limits<double>::max();
+        size_t bi = 0, bj = 0;
+        bool bEndI = false, bEndJ = false;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            for (size_t j = i + 1; j < paths.size(); ++j) {
+                for (int e = 0; e < 4; ++e) {
+                    const bool endI = (e & 1) != 0, endJ = (e & 2) != 0;
+                    const RlePoint& a = endI ? paths[i].path.back() : paths[i].path.front();
+                    const RlePoint& b = endJ ? paths[j].path.back() : paths[j].path.front();
+                    const double gr = b.row - a.row, gc = b.col - a.col;
+                    const double d = std::hypot(gr, gc);
+                    if (d > maxGap || d >= best) {
+                        continue;
+                    }
+                    if (maxGapRelative > 0.0 && d > maxGapRelative * std::max(paths[i].length, paths[j].length)) {
+                        continue;
+                    }
+                    if (d > 1e-9 && (!directionAccepted(paths[i].path, endI, gr / d, gc / d, maxAngle) ||
+                        !directionAccepted(paths[j].path, endJ, -gr / d, -gc / d, maxAngle))) {
+                        continue;
+                    }
+                    best = d;
+                    bi = i;
+                    bj = j;
+                    bEndI = endI;
+                    bEndJ = endJ;
+                }
+            }
+        }
+        if (best == std::numeric_limits<double>::max()) {
+            break;
+        }
+
+        // 前一段调整为尾端相接，后一段调整为首端相接
+        Measurement& head = paths[bi];
+        Measurement& tail = paths[bj];
+        if (!bEndI) {
+            std::reverse(head.path.begin(), head.path.end());
+        }
+        if (bEndJ) {
+            std::reverse(tail.path.begin(), tail.path.end());
+        }
+        head.path.insert(head.path.end(), tail.path.begin(), tail.path.end());
+        head.length += best + tail.length;
+        paths.erase(paths.begin() + bj);
+    }
+
+    std::sort(paths.begin(), paths.end(), [](const Measurement& a, const Measurement& b) {
+        return a.length > b.length;
+    });
+    return paths;
+}
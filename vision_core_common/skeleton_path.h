@@ -0,0 +1,46 @@
+﻿#ifndef SKELETON_PATH_H
+#define SKELETON_PATH_H
+#include <vector>
+#include <cstdint>
+#include "rle_region.h"
+
+
+/*
+    原生骨架最长路径测长 ---- 替代 Skeleton -> GenContoursSkeletonXld -> SegmentContoursXld ->
+    UnionCollinear/UnionAdjacentContoursXld -> SelectContoursXld -> SmoothContoursXld -> LengthXld
+    1. 细化：区域按位压缩（每个uint64存64个像素），Zhang-Suen两子迭代用位运算一次处理64个像素，
+       按行分块多线程；只处理上两次子迭代中邻域有变化的行
+    2. 骨架图：8邻域像素图，轴向边长1、对角边长sqrt(2)
+    3. 最长测地路径：每个骨架连通域两遍最短路（任取一点求最远点A，再从A求最远点B），A-B路径即主干，
+       分叉和毛刺自然排除，不依赖轮廓分段和间隙连接的启发式参数
+    4. 路径按窗口滑动平均到亚像素（端点窗口对称收缩，端点保持不动）后计算折线长度
+    5. 可选的间隙连接：端点距离不超过maxGap且两端切向与连线夹角不超过maxAngle的路径首尾相接，
+       间隙按直线段计入长度；maxAngle取pi即不限方向。对应UnionCollinearContoursXld（限夹角）和
+       UnionAdjacentContoursXld（不限夹角，maxGapRelative限制间隙不超过较长路径长度的倍数）
+*/
+class SkeletonPath
+{
+public:
+    // 单个骨架连通域的测量结果
+    struct Measurement {
+        std::vector<RlePoint> path;     // 平滑后的主干路径（像素中心坐标）
+        double length = 0.0;
+    };
+
+    // 细化为8连通、单像素宽的骨架
+    static RleRegion thin(const RleRegion& region, int threads = 0);
+    // 单个连通骨架的最长测地路径（像素中心，按路径顺序）
+    static std::vector<RlePoint> longestPath(const RleRegion& skeleton);
+    // 滑动平均平滑，window为窗口点数（偶数按+1处理）
+    static std::vector<RlePoint> smooth(const std::vector<RlePoint>& path, int window);
+    static double length(const std::vector<RlePoint>& path);
+
+    // 细化 -> 各骨架连通域最长路径 -> 平滑 -> 测长，结果按长度降序
+    static std::vector<Measurement> measure(const RleRegion& region, int smoothWindow, int threads = 0);
+    // 间隙连接：每次连接距离最近的一对合格端点，直到没有可连接的端点；结果按长度降序
+    // maxGapRelative > 0时间隙还需不超过两条路径中较长者长度的maxGapRelative倍
+    static std::vector<Measurement> bridge(std::vector<Measurement> paths, double maxGap, double maxAngle,
+        double maxGapRelative = 0.0);
+};
+
+#endif // SKELETON_PATH_H
@@ -0,0 +1,232 @@
+﻿#include "fabric_preprocess.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FABRIC_PREPROCESS_SSE2
+#endif
+
+
+namespace {
+
+// 图像边界镜像（边界像素本身不重复）：-1 -> 1, n -> n - 2
+inline int mirrorIndex(int i, int n)
+{
+    if (n == 1) {
+        return 0;
+    }
+    if (i < 0) {
+        i = -i;
+    }
+    if (i >= n) {
+        i = 2 * n - 2 - i;
+    }
+    return i;
+}
+
+// colSum[i] += in[i] - out[i]
+void updateColumnSums(int32_t* colSum, const uint8_t* in, const uint8_t* out, int count)
+{
+    int i = 0;
+#ifdef FABRIC_PREPROCESS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i));
+        __m128i dlo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i dhi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        // 16位差值符号扩展到32位
+        __m128i d0 = _mm_srai_epi32(_mm_unpacklo_epi16(dlo, dlo), 16);
+        __m128i d1 = _mm_srai_epi32(_mm_unpackhi_epi16(dlo, dlo), 16);
+        __m128i d2 = _mm_srai_epi32(_mm_unpacklo_epi16(dhi, dhi), 16);
+        __m128i d3 = _mm_srai_epi32(_mm_unpackhi_epi16(dhi, dhi), 16);
+        __m128i* s = reinterpret_cast<__m128i*>(colSum + i);
+        _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), d0));
+        _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), d1));
+        _mm_storeu_si128(s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2), d2));
+        _mm_storeu_si128(s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3), d3));
+    }
+#endif
+    for (; i < count; ++i) {
+        colSum[i] += static_cast<int32_t>(in[i]) - static_cast<int32_t>(out[i]);
+    }
+}
+
+} // namespace
+
+void FabricPreprocess::buildStretchLut(int minGray, int maxGray, uint8_t* lut)
+{
+    if (maxGray <= minGray) {
+        for (int g = 0; g < 256; ++g) {
+            lut[g] = static_cast<uint8_t>(g);
+        }
+        return;
+    }
+    const double scale = 255.0 / (maxGray - minGray);
+    for (int g = 0; g < 256; ++g) {
+        double v = (g - minGray) * scale + 0.5;
+        v = std::min(std::max(v, 0.0), 255.0);
+        lut[g] = static_cast<uint8_t>(v);
+    }
+}
+
+const uint8_t* FabricPreprocess::loadRow(int seq)
+{
+    const int cw = colLast_ - colFirst_ + 1;
+    const int slots = static_cast<int>(ring_.size()) / cw;
+    uint8_t* dst = ring_.data() + static_cast<size_t>((seq - seqBase_) % slots) * cw;
+    const uint8_t* src = image_ + static_cast<size_t>(mirrorIndex(seq, height_)) * stride_ + colFirst_;
+    for (int i = 0; i < cw; ++i) {
+        dst[i] = lut_[src[i]];
+    }
+    return dst;
+}
+
+void FabricPreprocess::meanRow(const std::vector<RleRun>& domain, size_t runBegin, size_t runEnd)
+{
+    const int32_t* cs = colSum_.data() - colFirst_;
+    const uint32_t half = static_cast<uint32_t>((left_ + right_ + 1) * (top_ + bottom_ + 1) / 2);
+    for (size_t k = runBegin; k < runEnd; ++k) {
+        const int cb = domain[k].colBegin;
+        const int ce = domain[k].colEnd;
+        int32_t sum = 0;
+        for (int i = cb - left_; i <= cb + right_; ++i) {
+            sum += cs[mirrorIndex(i, width_)];
+        }
+        for (int x = cb; ; ++x) {
+            const uint64_t v = (static_cast<uint64_t>(sum) + half) * divMul_;
+            means_.push_back(static_cast<uint8_t>(v >> divShift_));
+            if (x == ce) {
+                break;
+            }
+            sum += cs[mirrorIndex(x + right_ + 1, width_)] - cs[mirrorIndex(x - left_, width_)];
+        }
+    }
+}
+
+bool FabricPreprocess::run(const uint8_t* image, int width, int height, int stride, const RleRegion& domainRegion,
+    int maskWidth, int maskHeight, int thresholdMin, RleRegion* outRegion)
+{
+    *outRegion = RleRegion();
+    means_.clear();
+    const RleRegion clipped = RleOps::clip(domainRegion, width, height);
+    const std::vector<RleRun>& domain = clipped.runs();
+    if (image == nullptr || width <= 0 || height <= 0 || domain.empty()) {
+        return false;
+    }
+    image_ = image;
+    width_ = width;
+    height_ = height;
+    stride_ = stride;
+
+    // step1: 定义域直方图 -> 第一次拉伸查找表
+    uint32_t hist[256] = {};
+    int minCol = width, maxCol = -1;
+    for (const auto& r : domain) {
+        const uint8_t* p = image + static_cast<size_t>(r.row) * stride;
+        for (int c = r.colBegin; c <= r.colEnd; ++c) {
+            ++hist[p[c]];
+        }
+        minCol = std::min(minCol, static_cast<int>(r.colBegin));
+        maxCol = std::max(maxCol, static_cast<int>(r.colEnd));
+    }
+    int minGray = 0, maxGray = 255;
+    while (minGray < 255 && hist[minGray] == 0) {
+        ++minGray;
+    }
+    while (maxGray > 0 && hist[maxGray] == 0) {
+        --maxGray;
+    }
+    buildStretchLut(minGray, maxGray, lut_);
+
+    // step2: 窗口参数与整数除法常数，窗口不超过图像尺寸
+    const int mw = std::min(std::max(maskWidth, 1), std::min(width, 255));
+    const int mh = std::min(std::max(maskHeight, 1), std::min(height, 255));
+    left_ = mw / 2;
+    right_ = mw - 1 - left_;
+    top_ = mh / 2;
+    bottom_ = mh - 1 - top_;
+    // sum + n/2 < 2^24，取 k = 24 + ceil(log2 n)、M = floor(2^k / n) + 1 时 (x * M) >> k == x / n
+    const uint32_t n = static_cast<uint32_t>(mw * mh);
+    int logN = 0;
+    while ((1u << logN) < n) {
+        ++logN;
+    }
+    divShift_ = 24 + logN;
+    divMul_ = static_cast<uint32_t>((uint64_t(1) << divShift_) / n + 1);
+
+    // 列范围外扩一个窗口，镜像后的列索引都落在范围内
+    colFirst_ = std::max(0, minCol - mw);
+    colLast_ = std::min(width - 1, maxCol + mw);
+    const int cw = colLast_ - colFirst_ + 1;
+    ring_.resize(static_cast<size_t>(mh + 1) * cw);
+    colSum_.assign(cw, 0);
+
+    const int rowFirst = domain.front().row;
+    const int rowLast = domain.back().row;
+    seqBase_ = rowFirst - top_;
+    for (int seq = rowFirst - top_; seq <= rowFirst + bottom_; ++seq) {
+        const uint8_t* row = loadRow(seq);
+        for (int i = 0; i < cw; ++i) {
+            colSum_[i] += row[i];
+        }
+    }
+
+    // step3: 逐行滑动，计算定义域内的均值
+    size_t k = 0;
+    for (int y = rowFirst; y <= rowLast; ++y) {
+        size_t runEnd = k;
+        while (runEnd < domain.size() && domain[runEnd].row == y) {
+            ++runEnd;
+        }
+        meanRow(domain, k, runEnd);
+        k = runEnd;
+        if (y == rowLast) {
+            break;
+        }
+        const int slots = mh + 1;
+        const uint8_t* outRow = ring_.data() + static_cast<size_t>((y - top_ - seqBase_) % slots) * cw;
+        const uint8_t* inRow = loadRow(y + bottom_ + 1);
+        updateColumnSums(colSum_.data(), inRow, outRow, cw);
+    }
+
+    // step4: 第二次拉伸与阈值合成为通过表，扫描均值输出游程
+    uint8_t meanMin = 255, meanMax = 0;
+    for (uint8_t v : means_) {
+        meanMin = std::min(meanMin, v);
+        meanMax = std::max(meanMax, v);
+    }
+    uint8_t lut2[256];
+    buildStretchLut(meanMin, meanMax, lut2);
+    bool pass[256];
+    for (int v = 0; v < 256; ++v) {
+        pass[v] = lut2[v] >= thresholdMin;
+    }
+
+    // 规范化的定义域游程互不相接，输出游程无需合并
+    std::vector<RleRun> runs;
+    auto emit = [&runs](int32_t row, int32_t cb, int32_t ce) {
+        runs.push_back({ row, cb, ce });
+    };
+    const uint8_t* m = means_.data();
+    for (const auto& r : domain) {
+        int start = -1;
+        for (int c = r.colBegin; c <= r.colEnd; ++c, ++m) {
+            if (pass[*m]) {
+                if (start < 0) {
+                    start = c;
+                }
+            }
+            else if (start >= 0) {
+                emit(r.row, start, c - 1);
+                start = -1;
+            }
+        }
+        if (start >= 0) {
+            emit(r.row, start, r.colEnd);
+        }
+    }
+    *outRegion = RleRegion::fromNormalized(std::move(runs));
+    return true;
+}
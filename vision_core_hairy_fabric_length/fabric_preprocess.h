@@ -0,0 +1,64 @@
+﻿#ifndef FABRIC_PREPROCESS_H
+#define FABRIC_PREPROCESS_H
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "rle_region.h"
+
+
+/*
+    毛羽布料预处理融合核 ---- 等价于 ScaleImageMax -> MeanImage -> ScaleImageMax -> Threshold(thMin, 255)
+    1. 第一次拉伸：定义域内一次直方图得到min/max，拉伸查找表在读入行时直接应用
+    2. 均值滤波：列和随行滑动更新(SSE2)、行内滑动窗口求和，耗时与掩膜大小无关；图像边界镜像
+    3. 第二次拉伸 + 阈值：两次拉伸都是单调映射，合成为均值上的一张256项通过表，
+       直接扫描均值输出游程编码的二值区域
+    中间结果只有定义域内的均值（每像素1字节），不生成拉伸图、均值图等整幅中间图像
+    非线程安全：每个算法实例持有自己的对象，工作区在多次调用之间复用
+*/
+class FabricPreprocess
+{
+public:
+    FabricPreprocess() = default;
+
+    // image为8位单通道图像，stride为行字节数；domain为定义域（裁剪到图像内）
+    // maskWidth/maskHeight为均值滤波窗口（1~255，超过图像尺寸时截断）
+    // 输出二值区域，定义域为空时返回false
+    bool run(const uint8_t* image, int width, int height, int stride, const RleRegion& domain,
+        int maskWidth, int maskHeight, int thresholdMin, RleRegion* out);
+
+    // 拉伸查找表：lut[g] = round((g - min) * 255 / (max - min))，截断到[0, 255]；max == min时为恒等映射
+    static void buildStretchLut(int minGray, int maxGray, uint8_t* lut);
+
+private:
+    // 计算一个输出行的均值（只计算定义域游程覆盖的像素），追加到means_
+    void meanRow(const std::vector<RleRun>& domain, size_t runBegin, size_t runEnd);
+    // 把序列位置seq对应的（镜像后的）图像行拉伸后写入环形缓存
+    const uint8_t* loadRow(int seq);
+
+private:
+    const uint8_t* image_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    int stride_ = 0;
+    // 处理的列范围[colFirst_, colLast_]（定义域外扩半个窗口）
+    int colFirst_ = 0;
+    int colLast_ = 0;
+    // 窗口相对中心的左/右/上/下延伸像素数
+    int left_ = 0;
+    int right_ = 0;
+    int top_ = 0;
+    int bottom_ = 0;
+    // 环形缓存第0行对应的序列位置
+    int seqBase_ = 0;
+    // 均值的整数除法：(sum + n/2) * divMul_ >> divShift_
+    uint32_t divMul_ = 0;
+    int divShift_ = 0;
+    uint8_t lut_[256] = {};
+
+    // 复用的工作区
+    std::vector<uint8_t> ring_;
+    std::vector<int32_t> colSum_;
+    std::vector<uint8_t> means_;
+};
+
+#endif // FABRIC_PREPROCESS_H
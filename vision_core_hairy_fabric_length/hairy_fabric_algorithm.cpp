@@ -3,45 +3,21 @@
 #include "result_shape.h"
 #include "logger_utils.h"
 #include "roi_shape.h"
+#include "result_batch.h"
+#include "image_channel.h"
+#include "rle_region.h"
+#include "skeleton_path.h"
 
-#include <QPainterPath>
 #include <memory>
 #include <exception>
 #include <cmath>
+#include <algorithm>
 #include <QDebug>
 
 
 
 using namespace HalconCpp;
 
-//用于格式转换
-HObject QImageRGB32ToHObject(const QImage& qImg)
-{
-    HObject ho_Image;
-    if (qImg.isNull() || qImg.format() != QImage::Format_RGB32) {
-        std::cerr << "错误：输入QImage为空或格式不是RGB32" << std::endl;
-        return ho_Image;
-    }
-    int width = qImg.width();
-    int height = qImg.height();
-    // RGB32 stride 必须是 width * 4，但在某些对齐下可能不同，严谨的做法是用 bytesPerLine
-    // 但 Halcon GenImageInterleaved 默认行连续。这里假设是紧凑排列。
-    int bufferSize = width * height * 4;
-
-    uchar* pBuffer = new(std::nothrow) uchar[bufferSize];
-    if (pBuffer == nullptr) return ho_Image;
-    std::memcpy(pBuffer, qImg.bits(), bufferSize);
-
-    try {
-        GenImageInterleaved(&ho_Image, (Hlong)pBuffer, "bgrx",
-            width, height, 0, "byte", width, height, 0, 0, -1, 0);
-    }
-    catch (const HOperatorException& e) { ho_Image = HObject(); }
-
-    delete[] pBuffer;
-    return ho_Image;
-}
-
 //正式
 HairyFabricAlgorithm::HairyFabricAlgorithm() :
     prop_obj_(new ConfigurableObject()),
@@ -83,6 +59,31 @@ void HairyFabricAlgorithm::setupProperties()
         .defaultValue(25)
         .registerTo(prop_obj_);
 
+    PropertyBuilder::create("预处理实现", "preprocess_backend")
+        .category("预处理")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生融合", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("粗到细缩放", "coarse_scale")
+        .category("预处理")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"关闭", 0},
+                {"1/4", 1},
+                {"1/8", 2} })
+        .defaultValue("关闭")
+        .registerTo(prop_obj_);
+
+    PropertyBuilder::create("区域运算实现", "region_backend")
+        .category("预处理")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
     PropertyBuilder::create("二值化下限", "threshold_min")
         .category("预处理")
         .type(QMetaType::Int)
@@ -127,6 +128,14 @@ void HairyFabricAlgorithm::setupProperties()
         .defaultValue(41) 
         .registerTo(prop_obj_);
 
+    PropertyBuilder::create("骨架测长实现", "skeleton_backend")
+        .category("骨架参数")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
     prop_obj_->registerBtn(1, "测试运行");
     prop_obj_->registerBtn(2, "保存模板图像");
 }
@@ -136,29 +145,117 @@ void HairyFabricAlgorithm::setParameters(const QJsonObject& p) { prop_obj_->setP
 void HairyFabricAlgorithm::setRunParameters(const QMap<QString, QList<QPair<QString, QVariant>>>& p) {
     for (auto it = p.begin(); it != p.end(); it++) prop_obj_->setPropertyEnumValues(it.key(), it.value());
 }
-AlgorithmResult HairyFabricAlgorithm::run(const AlgorithmContext& context) { return test(context.input); }
+AlgorithmResult HairyFabricAlgorithm::run(const AlgorithmContext& context) {
+    return test(context.input, RoiAlignment::fromVariant(context.getData(RoiAlignment::contextKey(), QVariant())));
+}
+
+// 粗到细主区域提取结果
+struct CoarseMainRegion {
+    HObject white;      // 全分辨率白色区域（粗区域内核 + 边界带内的全分辨率阈值）
+    HObject smooth;     // 精细化后的主区域（填充 + 开运算）
+    double roughLen;    // 粗分辨率最小外接矩形长度（已换算到全分辨率）
+    double ratio;       // 粗分辨率矩形填充率
+};
+
+// 由最值计算 ScaleImage 参数，等价于 ScaleImageMax
+static void stretchParams(double minGray, double maxGray, double* mult, double* add)
+{
+    if (maxGray > minGray) {
+        *mult = 255.0 / (maxGray - minGray);
+        *add = -*mult * minGray;
+    }
+    else {
+        *mult = 1.0;
+        *add = 0.0;
+    }
+}
+
+// 粗到细：主区域和模式判定在1/factor分辨率上完成，全分辨率只处理粗区域边界附近的带状区域
+// 两次拉伸的参数粗细两级共用（第一次取全分辨率ROI最值，第二次取粗分辨率均值图最值），保证阈值一致
+static bool extractMainRegionCoarse(const HObject& image, const HObject& roi, int factor, int meanMask, int thMin,
+    double stdPercent, double openRadius, CoarseMainRegion* out)
+{
+    const double inv = 1.0 / factor;
+    HTuple gMin, gMax, gRange;
+    MinMaxGray(roi, image, 0, &gMin, &gMax, &gRange);
+    double mult1, add1;
+    stretchParams(gMin.D(), gMax.D(), &mult1, &add1);
+
+    // 1. 粗分辨率：区域平均缩小后走同样的 拉伸-均值-拉伸-阈值-主区域 流程
+    HObject ho_Small, ho_SmallRoi, ho_SmallReduced, ho_SmallScaled, ho_SmallMean, ho_SmallMeanScaled;
+    HObject ho_SmallWhite, ho_SmallConnected, ho_SmallMain, ho_SmallFilled, ho_SmallSmooth;
+    ZoomImageFactor(image, &ho_Small, inv, inv, "constant");
+    ZoomRegion(roi, &ho_SmallRoi, inv, inv);
+    ReduceDomain(ho_Small, ho_SmallRoi, &ho_SmallReduced);
+    ScaleImage(ho_SmallReduced, &ho_SmallScaled, mult1, add1);
+    const int smallMask = std::max(1, (meanMask + factor / 2) / factor);
+    MeanImage(ho_SmallScaled, &ho_SmallMean, smallMask, smallMask);
+    HTuple mMin, mMax;
+    MinMaxGray(ho_SmallRoi, ho_SmallMean, 0, &mMin, &mMax, &gRange);
+    double mult2, add2;
+    stretchParams(mMin.D(), mMax.D(), &mult2, &add2);
+    ScaleImage(ho_SmallMean, &ho_SmallMeanScaled, mult2, add2);
+    Threshold(ho_SmallMeanScaled, &ho_SmallWhite, thMin, 255);
+
+    Connection(ho_SmallWhite, &ho_SmallConnected);
+    SelectShapeStd(ho_SmallConnected, &ho_SmallMain, "max_area", stdPercent);
+    HTuple count; CountObj(ho_SmallMain, &count);
+    if (count.I() == 0) {
+        return false;
+    }
+    FillUp(ho_SmallMain, &ho_SmallFilled);
+    OpeningCircle(ho_SmallFilled, &ho_SmallSmooth, std::max(0.5, openRadius * inv));
+
+    // 模式判定：长度换算回全分辨率，填充率与尺度无关
+    HTuple row, col, phi, l1, l2, area, r, c;
+    SmallestRectangle2(ho_SmallSmooth, &row, &col, &phi, &l1, &l2);
+    AreaCenter(ho_SmallSmooth, &area, &r, &c);
+    const double areaRect = l1.D() * l2.D() * 4.0;
+    out->ratio = (areaRect > 0) ? (area.D() / areaRect) : 0.0;
+    out->roughLen = l1.D() * 2.0 * factor;
+
+    // 2. 粗区域放大回全分辨率，边界带(±2个粗像素)内重新做全分辨率阈值，带内侧直接保留
+    HObject ho_Coarse, ho_Core, ho_Outer, ho_Band, ho_BandWide, ho_BandReduced, ho_BandScaled;
+    HObject ho_BandMean, ho_BandMeanReduced, ho_BandMeanScaled, ho_BandWhite;
+    ZoomRegion(ho_SmallSmooth, &ho_Coarse, factor, factor);
+    const double bandRadius = 2.0 * factor;
+    ErosionCircle(ho_Coarse, &ho_Core, bandRadius);
+    Intersection(ho_Core, roi, &ho_Core);
+    DilationCircle(ho_Coarse, &ho_Outer, bandRadius);
+    Difference(ho_Outer, ho_Core, &ho_Band);
+    Intersection(ho_Band, roi, &ho_Band);
+    // 均值窗口需要带外半个掩膜范围内的拉伸值
+    DilationRectangle1(ho_Band, &ho_BandWide, meanMask, meanMask);
+    ReduceDomain(image, ho_BandWide, &ho_BandReduced);
+    ScaleImage(ho_BandReduced, &ho_BandScaled, mult1, add1);
+    MeanImage(ho_BandScaled, &ho_BandMean, meanMask, meanMask);
+    ReduceDomain(ho_BandMean, ho_Band, &ho_BandMeanReduced);
+    ScaleImage(ho_BandMeanReduced, &ho_BandMeanScaled, mult2, add2);
+    Threshold(ho_BandMeanScaled, &ho_BandWhite, thMin, 255);
+    Union2(ho_Core, ho_BandWhite, &out->white);
+
+    // 3. 全分辨率主区域（区域运算按游程计算，代价远小于整图滤波）
+    HObject ho_Connected, ho_Main, ho_Filled;
+    Connection(out->white, &ho_Connected);
+    SelectShapeStd(ho_Connected, &ho_Main, "max_area", stdPercent);
+    CountObj(ho_Main, &count);
+    if (count.I() == 0) {
+        return false;
+    }
+    FillUp(ho_Main, &ho_Filled);
+    OpeningCircle(ho_Filled, &out->smooth, openRadius);
+    return true;
+}
 
 // 辅助：调试显示
 void addDebugRegion(AlgorithmResult& result, const HObject& region, const QColor& color) {
-    if (!region.IsInitialized()) return;
-    HTuple count; CountObj(region, &count);
-    if (count.I() == 0) return;
-    int limit = (count.I() > 20) ? 20 : count.I();
-    for (int i = 1; i <= limit; ++i) {
-        HObject single; SelectObj(region, &single, i);
-        HTuple rows, cols;
-        try { GetRegionPolygon(single, 5.0, &rows, &cols); } catch(...) { continue; }
-        if (rows.Length() > 0) {
-            QPainterPath path;
-            path.moveTo(cols[0].D(), rows[0].D());
-            for (int k = 1; k < rows.Length(); ++k) path.lineTo(cols[k].D(), rows[k].D());
-            path.closeSubpath();
-            result.addResultShape(std::make_shared<ResultPath>(path, color));
-        }
-    }
+    // 最多20个区域的多边形边界合并为一个路径图形
+    ResultPolylineBatch polygons;
+    polygons.addRegions(region, 5.0, 20);
+    if (auto shape = polygons.toShape(color)) result.addResultShape(shape);
 }
 
-AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input)
+AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input, const RoiAlignment& alignment)
 {
     AlgorithmResult result;
     if (!init_param_status_) { result.setCode(-3); result.setMsg("参数未初始化"); return result; }
@@ -168,17 +265,21 @@ AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input)
         if (input.imageCount() <= 0) { result.setCode(-1); result.setMsg("无图像"); return result; }
         
         // 这里的 getImageAsHObject 会根据 QImage 形式转换，封装起来看不到其该函数内容，但转换出来的均为单通道HObject形式，无法在后面提取blue通道
+        // 因此直接从QImage中一次抽取算法需要的通道（通道号与"bgrx"交错转换后的三通道图一致，3为蓝色）
         QImage qImg = input.getQImage(0);
-        qDebug() << "[HairyFabric] Detected Channels:" << qImg.format();
-        HObject hImg = QImageRGB32ToHObject(qImg);
-        if (!hImg.IsInitialized())
-                 {
-                     qDebug() << "图像转换失败";
-                     return result;
-                 }
-        // 获取参数
         int blueCh = prop_obj_->propValue("blue_channel").toInt();
+        HObject hImg = ImageChannel::toHObject(qImg, blueCh);
+        if (!hImg.IsInitialized()) {
+            qDebug() << "[HairyFabric] 图像转换失败, format:" << qImg.format() << "channel:" << blueCh;
+            result.setCode(-2);
+            result.setMsg("图像转换失败（需RGB32/ARGB32或Grayscale8，通道号1~3）");
+            result.setResultType(ResultType::NG);
+            return result;
+        }
+        // 获取参数
         int meanMask = prop_obj_->propValue("mean_mask_size").toInt();
+        const QString coarseScale = prop_obj_->propValue("coarse_scale").toString();
+        const int coarseFactor = coarseScale == "1/4" ? 4 : (coarseScale == "1/8" ? 8 : 1);
         int thMin = prop_obj_->propValue("threshold_min").toInt();
         double stdPercent = prop_obj_->propValue("std_percent").toDouble();
         double openRadLarge = prop_obj_->propValue("opening_radius_large").toDouble();
@@ -187,6 +288,8 @@ AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input)
         double rectRatioTh = prop_obj_->propValue("rect_ratio_th").toDouble();
         double skelEro = prop_obj_->propValue("skel_erosion").toDouble();
         int smoothSig = prop_obj_->propValue("smooth_sigma").toInt();
+        // 原生骨架测长：位压缩并行细化 + 骨架图最长测地路径，替代XLD分段/连接/选取
+        const bool nativeSkeleton = prop_obj_->propValue("skeleton_backend").toString() == "原生";
 
         // ROI 填充 
         HObject ho_ROI_Search; GenEmptyObj(&ho_ROI_Search);
@@ -238,6 +341,8 @@ AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input)
         if (!has_valid_roi) {
             ho_ROI_Search = ho_ImageRect;
         } else {
+            // ROI绘制在模板图像上，按上游匹配位姿变换到当前图像
+            ho_ROI_Search = alignment.mapRegion(ho_ROI_Search);
             Intersection(ho_ROI_Search, ho_ImageRect, &ho_ROI_Search);
             addDebugRegion(result, ho_ROI_Search, Qt::blue);
         }
@@ -250,134 +355,203 @@ AlgorithmResult HairyFabricAlgorithm::test(const AlgorithmInput& input)
         }
         
         // 4. 核心算法流程 (Halcon 代码移植)
-        HObject ho_ChannelImg, ho_Reduced, ho_Scaled, ho_Mean, ho_MeanScaled, ho_White;
+        HObject ho_Reduced, ho_Scaled, ho_Mean, ho_MeanScaled, ho_White;
         HObject ho_Connected, ho_Main, ho_Filled, ho_Smooth;
         HTuple hv_L1, hv_L2, hv_Phi, hv_Row, hv_Col, hv_Area, hv_AreaObj, hv_R1, hv_C1;
 
-        // ... 通道获取 ...
-        HTuple channels;
-        CountChannels(hImg, &channels);
-        if (channels.I() >= 3) {
-            // 如果上面转换用了 "bgrx"，这里 3 就是真正的 Blue 通道
-            AccessChannel(hImg, &ho_ChannelImg, blueCh);
+        // 粗到细模式下模式判定使用粗分辨率结果
+        bool coarseDecision = false;
+        CoarseMainRegion coarse;
+        // 原生区域后端：连通域/填充/开运算及后续腐蚀在游程区域上完成（粗到细模式始终使用Halcon）
+        const bool nativeRegion = coarseFactor == 1 && prop_obj_->propValue("region_backend").toString() == "原生";
+        RleRegion rleSmooth;
+        if (coarseFactor > 1) {
+            coarseDecision = extractMainRegionCoarse(hImg, ho_ROI_Search, coarseFactor, meanMask, thMin,
+                stdPercent, openRadLarge, &coarse);
+            if (!coarseDecision) {
+                result.setMsg("NG: 未找到主要区域 (粗分辨率 Threshold/SelectShapeStd 失败)");
+                result.setResultType(ResultType::OK);
+                return result;
+            }
+            ho_White = coarse.white;
+            ho_Smooth = coarse.smooth;
+            addDebugRegion(result, ho_White, Qt::red);
         }
         else {
-            AccessChannel(hImg, &ho_ChannelImg, 1);
-        }
-
-        ReduceDomain(ho_ChannelImg, ho_ROI_Search, &ho_Reduced);
+            RleRegion rleWhite;
+            if (prop_obj_->propValue("preprocess_backend").toString() == "原生融合") {
+                // 原生融合核：一次直方图 + 与掩膜大小无关的滑动均值 + 合成查找表阈值，直接输出游程区域
+                HTuple pointer, type, width, height;
+                GetImagePointer1(hImg, &pointer, &type, &width, &height);
+                preprocess_.run(reinterpret_cast<const uint8_t*>(pointer.L()), width.I(), height.I(), width.I(),
+                    RleRegion::fromHObject(ho_ROI_Search), meanMask, meanMask, thMin, &rleWhite);
+                ho_White = rleWhite.toHObject();
+            }
+            else {
+                ReduceDomain(hImg, ho_ROI_Search, &ho_Reduced);
 
-        // 步骤 1: 第一次拉伸
-        ScaleImageMax(ho_Reduced, &ho_Scaled);
+                // 步骤 1: 第一次拉伸
+                ScaleImageMax(ho_Reduced, &ho_Scaled);
 
-        // 步骤 2: 均值滤波
-        MeanImage(ho_Scaled, &ho_Mean, meanMask, meanMask);
+                // 步骤 2: 均值滤波
+                MeanImage(ho_Scaled, &ho_Mean, meanMask, meanMask);
 
-        // 步骤 3: 【新增】第二次拉伸 (Halcon 脚本中有这一步)
-        ScaleImageMax(ho_Mean, &ho_MeanScaled);
+                // 步骤 3: 【新增】第二次拉伸 (Halcon 脚本中有这一步)
+                ScaleImageMax(ho_Mean, &ho_MeanScaled);
 
-        // 步骤 4: 二值化 (对第二次拉伸后的图进行)
-        Threshold(ho_MeanScaled, &ho_White, thMin, 255);
+                // 步骤 4: 二值化 (对第二次拉伸后的图进行)
+                Threshold(ho_MeanScaled, &ho_White, thMin, 255);
+                if (nativeRegion) {
+                    rleWhite = RleRegion::fromHObject(ho_White);
+                }
+            }
 
-        addDebugRegion(result, ho_White, Qt::red);
+            addDebugRegion(result, ho_White, Qt::red);
 
+            if (nativeRegion) {
+                // 一次标记得到各连通域面积，SelectShapeStd("max_area")即查表取最大（百分比参数不参与）
+                const RleComponents components = RleComponents::label(rleWhite);
+                const int mainIdx = components.indexOfMaxArea();
+                if (mainIdx < 0) {
+                    result.setMsg("NG: 未找到主要区域 (Threshold/SelectShapeStd 失败)");
+                    result.setResultType(ResultType::OK);
+                    return result;
+                }
+                rleSmooth = RleOps::clip(RleOps::openingCircle(RleOps::fillUp(components.region(mainIdx)), openRadLarge),
+                    w.I(), h.I());
+                ho_Smooth = rleSmooth.toHObject();
+            }
+            else {
+                Connection(ho_White, &ho_Connected);
+                SelectShapeStd(ho_Connected, &ho_Main, "max_area", stdPercent);
+
+                HTuple countMain; CountObj(ho_Main, &countMain);
+                if (countMain.I() == 0) {
+                    result.setMsg("NG: 未找到主要区域 (Threshold/SelectShapeStd 失败)");
+                    result.setResultType(ResultType::OK); 
+                    // 即使失败，也尽量把中间结果画出来
+                    addDebugRegion(result, ho_White, Qt::red);
+                    return result;
+                }
 
-        Connection(ho_White, &ho_Connected);
-        SelectShapeStd(ho_Connected, &ho_Main, "max_area", stdPercent);
-        
-        HTuple countMain; CountObj(ho_Main, &countMain);
-        if (countMain.I() == 0) {
-            result.setMsg("NG: 未找到主要区域 (Threshold/SelectShapeStd 失败)");
-            result.setResultType(ResultType::OK); 
-            // 即使失败，也尽量把中间结果画出来
-            addDebugRegion(result, ho_White, Qt::red);
-            return result;
+                FillUp(ho_Main, &ho_Filled);
+                OpeningCircle(ho_Filled, &ho_Smooth, openRadLarge);
+            }
         }
 
-        FillUp(ho_Main, &ho_Filled);
-        OpeningCircle(ho_Filled, &ho_Smooth, openRadLarge);
-        
         addDebugRegion(result, ho_Smooth, QColor(0, 255, 0, 80));
 
-        SmallestRectangle2(ho_Smooth, &hv_Row, &hv_Col, &hv_Phi, &hv_L1, &hv_L2);
-        AreaCenter(ho_Smooth, &hv_AreaObj, &hv_R1, &hv_C1);
+        if (nativeRegion) {
+            // 面积与最小外接矩形由游程一次遍历得到（凸包 + 旋转卡壳）
+            const RleComponent feature = RleComponents::describe(rleSmooth);
+            hv_Row = feature.rect.row;
+            hv_Col = feature.rect.col;
+            hv_Phi = feature.rect.phi;
+            hv_L1 = feature.rect.length1;
+            hv_L2 = feature.rect.length2;
+            hv_AreaObj = static_cast<double>(feature.area);
+        }
+        else {
+            SmallestRectangle2(ho_Smooth, &hv_Row, &hv_Col, &hv_Phi, &hv_L1, &hv_L2);
+            AreaCenter(ho_Smooth, &hv_AreaObj, &hv_R1, &hv_C1);
+        }
         
         double areaRect = hv_L1.D() * hv_L2.D() * 4.0;
         double ratio = (areaRect > 0) ? (hv_AreaObj.D() / areaRect) : 0.0;
         double roughLen = hv_L1.D() * 2.0;
+        const double decisionLen = coarseDecision ? coarse.roughLen : roughLen;
+        const double decisionRatio = coarseDecision ? coarse.ratio : ratio;
 
         double finalLength = 0.0;
         QString modeStr = "";
 
-        if (roughLen <= rectLenTh && ratio > rectRatioTh) {
+        if (decisionLen <= rectLenTh && decisionRatio > rectRatioTh) {
             // === 模式 A: 矩形模式 ===
             modeStr = "Rectangle";
             finalLength = roughLen;
 
             HObject ho_RectContour;
             GenRectangle2ContourXld(&ho_RectContour, hv_Row, hv_Col, hv_Phi, hv_L1, hv_L2);
-            HTuple r, c; GetContourXld(ho_RectContour, &r, &c);
-            
-            QPainterPath rectPath;
-            if(r.Length() > 0) {
-                rectPath.moveTo(c[0].D(), r[0].D());
-                for(int k=1; k<r.Length(); ++k) rectPath.lineTo(c[k].D(), r[k].D());
-                rectPath.closeSubpath();
-            }
-            result.addResultShape(std::make_shared<ResultPath>(rectPath, Qt::green));
+            ResultPolylineBatch rectPath;
+            rectPath.addContours(ho_RectContour, true);
+            if (auto shape = rectPath.toShape(Qt::green)) result.addResultShape(shape);
 
             double dRow = -std::sin(hv_Phi.D()) * hv_L1.D();
             double dCol = std::cos(hv_Phi.D()) * hv_L1.D();
             
-            QPainterPath linePath;
-            linePath.moveTo(hv_Col.D() - dCol, hv_Row.D() - dRow);
-            linePath.lineTo(hv_Col.D() + dCol, hv_Row.D() + dRow);
-            result.addResultShape(std::make_shared<ResultPath>(linePath, Qt::red));
+            ResultPolylineBatch linePath;
+            linePath.addLine(hv_Col.D() - dCol, hv_Row.D() - dRow, hv_Col.D() + dCol, hv_Row.D() + dRow);
+            if (auto shape = linePath.toShape(Qt::red)) result.addResultShape(shape);
 
         } else {
             // === 模式 B: 骨架提取模式 ===
             modeStr = "Skeleton";
             
-            HObject ho_Core, ho_Skel, ho_SkelCont, ho_Split, ho_Cand;
-            HObject ho_UnionCol, ho_FinalUnion, ho_BestLine, ho_Smoothed;
-
-            ErosionCircle(ho_Smooth, &ho_Core, skelEro);
-            Skeleton(ho_Core, &ho_Skel);
-            GenContoursSkeletonXld(ho_Skel, &ho_SkelCont, 1, "filter");
-            SegmentContoursXld(ho_SkelCont, &ho_Split, "lines_circles", 1, 1, 1);
-            SelectContoursXld(ho_Split, &ho_Cand, "contour_length", 10, 9999999, -0.5, 0.5);
-            
-            UnionCollinearContoursXld(ho_Cand, &ho_UnionCol, 100, 2.0, 20, 0.7, "attr_keep");
-            UnionAdjacentContoursXld(ho_UnionCol, &ho_FinalUnion, 20, 1, "attr_keep");
-            SelectContoursXld(ho_FinalUnion, &ho_BestLine, "contour_length", 100, 9999999, -0.5, 0.5);
-
-            HTuple numCand; CountObj(ho_BestLine, &numCand);
-            if (numCand.I() > 0) {
-                HObject ho_FinalSkel;
-                if (numCand.I() > 1) {
-                    HTuple lens, indices;
-                    LengthXld(ho_BestLine, &lens);
-                    TupleSortIndex(lens, &indices);
-                    SelectObj(ho_BestLine, &ho_FinalSkel, indices[numCand.I()-1].I() + 1);
-                } else {
-                    CopyObj(ho_BestLine, &ho_FinalSkel, 1, 1);
+            if (nativeSkeleton) {
+                // 最长测地路径即主干，分叉与毛刺不计入；平滑窗口沿用骨架平滑系数
+                const RleRegion core = RleOps::erosionCircle(nativeRegion ? rleSmooth : RleRegion::fromHObject(ho_Smooth), skelEro);
+                const std::vector<SkeletonPath::Measurement> paths = SkeletonPath::measure(core, smoothSig);
+                if (paths.empty() || paths.front().length < 100) {
+                    result.setMsg("NG: 骨架提取失败 (目标太碎)");
+                    result.setResultType(ResultType::OK);
+                    return result;
+                }
+                finalLength = paths.front().length;
+
+                std::vector<float> xy;
+                xy.reserve(paths.front().path.size() * 2);
+                for (const auto& pt : paths.front().path) {
+                    xy.push_back(static_cast<float>(pt.col));
+                    xy.push_back(static_cast<float>(pt.row));
+                }
+                ResultPolylineBatch skelPath(0.5);
+                skelPath.addPolyline(xy.data(), xy.size() / 2);
+                if (auto shape = skelPath.toShape(Qt::red)) result.addResultShape(shape);
+            }
+            else {
+                HObject ho_Core, ho_Skel, ho_SkelCont, ho_Split, ho_Cand;
+                HObject ho_UnionCol, ho_FinalUnion, ho_BestLine, ho_Smoothed;
+
+                if (nativeRegion) {
+                    ho_Core = RleOps::erosionCircle(rleSmooth, skelEro).toHObject();
+                }
+                else {
+                    ErosionCircle(ho_Smooth, &ho_Core, skelEro);
                 }
+                Skeleton(ho_Core, &ho_Skel);
+                GenContoursSkeletonXld(ho_Skel, &ho_SkelCont, 1, "filter");
+                SegmentContoursXld(ho_SkelCont, &ho_Split, "lines_circles", 1, 1, 1);
+                SelectContoursXld(ho_Split, &ho_Cand, "contour_length", 10, 9999999, -0.5, 0.5);
+            
+                UnionCollinearContoursXld(ho_Cand, &ho_UnionCol, 100, 2.0, 20, 0.7, "attr_keep");
+                UnionAdjacentContoursXld(ho_UnionCol, &ho_FinalUnion, 20, 1, "attr_keep");
+                SelectContoursXld(ho_FinalUnion, &ho_BestLine, "contour_length", 100, 9999999, -0.5, 0.5);
+
+                HTuple numCand; CountObj(ho_BestLine, &numCand);
+                if (numCand.I() > 0) {
+                    HObject ho_FinalSkel;
+                    if (numCand.I() > 1) {
+                        HTuple lens, indices;
+                        LengthXld(ho_BestLine, &lens);
+                        TupleSortIndex(lens, &indices);
+                        SelectObj(ho_BestLine, &ho_FinalSkel, indices[numCand.I()-1].I() + 1);
+                    } else {
+                        CopyObj(ho_BestLine, &ho_FinalSkel, 1, 1);
+                    }
 
-                SmoothContoursXld(ho_FinalSkel, &ho_Smoothed, smoothSig);
-                HTuple len; LengthXld(ho_Smoothed, &len);
-                finalLength = len.D();
+                    SmoothContoursXld(ho_FinalSkel, &ho_Smoothed, smoothSig);
+                    HTuple len; LengthXld(ho_Smoothed, &len);
+                    finalLength = len.D();
 
-                HTuple r, c; GetContourXld(ho_Smoothed, &r, &c);
-                QPainterPath skelPath;
-                if (r.Length() > 0) {
-                    skelPath.moveTo(c[0].D(), r[0].D());
-                    for(int k=1; k<r.Length(); ++k) skelPath.lineTo(c[k].D(), r[k].D());
-                    result.addResultShape(std::make_shared<ResultPath>(skelPath, Qt::red));
+                    // 骨架轮廓顶点数上千，抽稀到半像素后显示
+                    ResultPolylineBatch skelPath(0.5);
+                    skelPath.addContours(ho_Smoothed);
+                    if (auto shape = skelPath.toShape(Qt::red)) result.addResultShape(shape);
+                } else {
+                    result.setMsg("NG: 骨架提取失败 (目标太碎)");
+                    result.setResultType(ResultType::OK);
+                    return result;
                 }
-            } else {
-                result.setMsg("NG: 骨架提取失败 (目标太碎)");
-                result.setResultType(ResultType::OK);
-                return result;
             }
         }
 
@@ -3,6 +3,8 @@
 
 #include "ialgorithm.h"
 #include "configurable_object.h"
+#include "roi_alignment.h"
+#include "fabric_preprocess.h"
 #define NOMINMAX
 #include <halconCpp/HalconCpp.h>
 
@@ -20,7 +22,8 @@ public:
     virtual void setParameters(const QJsonObject& p) override;
 
     virtual AlgorithmResult run(const AlgorithmContext& input) override;
-    AlgorithmResult test(const AlgorithmInput& input);
+    // alignment：ROI位姿对齐（run()中由上游匹配步骤写入上下文的位姿给出），默认不对齐
+    AlgorithmResult test(const AlgorithmInput& input, const RoiAlignment& alignment = RoiAlignment());
 
 private:
     void setupProperties();
@@ -28,6 +31,8 @@ private:
 private:
     ConfigurableObject* prop_obj_;
     bool init_param_status_;
+    // 原生融合预处理（拉伸-均值-拉伸-阈值），工作区跨帧复用
+    FabricPreprocess preprocess_;
 };
 
 #endif // HAIRY_FABRIC_ALGORITHM_H
\ No newline at end of file
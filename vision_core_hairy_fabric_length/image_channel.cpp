@@ -0,0 +1,105 @@
+﻿#include "image_channel.h"
+#include <cstring>
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_CHANNEL_SSE2
+#endif
+
+using namespace HalconCpp;
+
+namespace ImageChannel
+{
+
+namespace {
+
+// 单行抽取：SSE2下每16个像素为一组，移位+掩码取目标字节，两次饱和打包得到16个连续字节
+void extractRow(const uint8_t* src, int width, int byteOffset, uint8_t* dst)
+{
+    int x = 0;
+#ifdef IMAGE_CHANNEL_SSE2
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i shift = _mm_cvtsi32_si128(8 * byteOffset);
+    for (; x + 16 <= width; x += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(src + 4 * x);
+        __m128i a = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(p), shift), mask);
+        __m128i b = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(p + 1), shift), mask);
+        __m128i c = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(p + 2), shift), mask);
+        __m128i d = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(p + 3), shift), mask);
+        // 值域0~255，有符号32->16位饱和打包不会截断
+        __m128i ab = _mm_packs_epi32(a, b);
+        __m128i cd = _mm_packs_epi32(c, d);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(ab, cd));
+    }
+#endif
+    const uint8_t* s = src + byteOffset;
+    for (; x < width; ++x) {
+        dst[x] = s[4 * x];
+    }
+}
+
+} // namespace
+
+void extract(const uint8_t* src, int width, int height, int srcStride, int byteOffset,
+    uint8_t* dst, int dstStride)
+{
+    if (src == nullptr || dst == nullptr || width <= 0 || height <= 0 || byteOffset < 0 || byteOffset > 3) {
+        return;
+    }
+    for (int y = 0; y < height; ++y) {
+        extractRow(src + static_cast<size_t>(y) * srcStride, width, byteOffset,
+            dst + static_cast<size_t>(y) * dstStride);
+    }
+}
+
+int byteOffsetOfChannel(int channel)
+{
+    // 小端序下QImage 32位像素在内存中为 B, G, R, X
+    switch (channel) {
+    case 1: return 2;
+    case 2: return 1;
+    case 3: return 0;
+    default: return -1;
+    }
+}
+
+HObject toHObject(const QImage& image, int channel)
+{
+    HObject ho_Image;
+    if (image.isNull()) {
+        return ho_Image;
+    }
+    const QImage::Format format = image.format();
+    const bool is32 = format == QImage::Format_RGB32 || format == QImage::Format_ARGB32
+        || format == QImage::Format_ARGB32_Premultiplied;
+    const bool isGray = format == QImage::Format_Grayscale8;
+    const int byteOffset = byteOffsetOfChannel(channel);
+    if ((!is32 && !isGray) || (is32 && byteOffset < 0)) {
+        return ho_Image;
+    }
+
+    const int width = image.width();
+    const int height = image.height();
+    const int srcStride = image.bytesPerLine();
+    // constBits()不会触发QImage的深拷贝(detach)
+    const uint8_t* src = image.constBits();
+
+    GenImageConst(&ho_Image, "byte", width, height);
+    HTuple pointer, type, w, h;
+    GetImagePointer1(ho_Image, &pointer, &type, &w, &h);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(pointer.L());
+
+    if (is32) {
+        extract(src, width, height, srcStride, byteOffset, dst, width);
+    }
+    else if (srcStride == width) {
+        std::memcpy(dst, src, static_cast<size_t>(width) * height);
+    }
+    else {
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(dst + static_cast<size_t>(y) * width, src + static_cast<size_t>(y) * srcStride, width);
+        }
+    }
+    return ho_Image;
+}
+
+} // namespace ImageChannel
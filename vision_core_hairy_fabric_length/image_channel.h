@@ -0,0 +1,30 @@
+﻿#ifndef IMAGE_CHANNEL_H
+#define IMAGE_CHANNEL_H
+#include <cstdint>
+#include <QImage>
+#define NOMINMAX
+#include <halconCpp/HalconCpp.h>
+
+
+/*
+    单通道抽取 ---- 直接从QImage::bits()按行步长(bytesPerLine)读取，只取需要的一个通道
+    1. 原流程：整图拷贝 -> GenImageInterleaved拆成三通道 -> AccessChannel，三次整图遍历
+    2. 这里一次遍历，SSE2每次处理16个像素，写入Halcon自有的单通道byte图像或调用方提供的缓冲区
+    通道编号与GenImageInterleaved("bgrx")生成的三通道图像一致：1=R, 2=G, 3=B
+*/
+namespace ImageChannel
+{
+    // 32位像素(B, G, R, X字节序)中取一个字节，byteOffset为0~3；dst按dstStride逐行写入width个字节
+    void extract(const uint8_t* src, int width, int height, int srcStride, int byteOffset,
+        uint8_t* dst, int dstStride);
+
+    // Halcon通道号(1~3)转换为QImage 32位像素内的字节偏移，非法通道返回-1
+    int byteOffsetOfChannel(int channel);
+
+    // 从QImage抽取一个通道到新建的Halcon单通道byte图像
+    // 支持RGB32/ARGB32/ARGB32_Premultiplied（按channel抽取）和Grayscale8（直接按行拷贝，忽略channel）
+    // 格式不支持或channel非法时返回未初始化的HObject
+    HalconCpp::HObject toHObject(const QImage& image, int channel);
+}
+
+#endif // IMAGE_CHANNEL_H
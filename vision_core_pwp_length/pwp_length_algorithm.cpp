@@ -3,10 +3,13 @@
 #include "result_shape.h" // 包含 ResultPath, ResultText
 #include "logger_utils.h"
 #include "roi_shape.h"    // 包含 RoiShape, RoiPolygon
+#include "result_batch.h"
+#include "rle_region.h"
+#include "skeleton_path.h"
 
-#include <QPainterPath>
 #include <memory> 
 #include <exception> 
+#include <algorithm>
 #include <QDebug> 
 
 using namespace HalconCpp;
@@ -69,12 +72,28 @@ void PwpLengthAlgorithm::setupProperties()
         .defaultValue(4000)
         .registerTo(prop_obj_);
 
+    PropertyBuilder::create("区域运算实现", "region_backend")
+        .category("预处理")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
     PropertyBuilder::create("最小骨架长度", "min_skel_len")
         .category("骨架提取")
         .type(QMetaType::Double)
         .defaultValue(50.0)
         .registerTo(prop_obj_);
 
+    PropertyBuilder::create("骨架测长实现", "skeleton_backend")
+        .category("骨架提取")
+        .type(QMetaType::QVariantMap)
+        .enums({ {"Halcon", 0},
+                {"原生", 1} })
+        .defaultValue("Halcon")
+        .registerTo(prop_obj_);
+
     PropertyBuilder::create("最大连接间隙", "max_gap")
         .category("轮廓连接")
         .type(QMetaType::Double)
@@ -104,43 +123,20 @@ void PwpLengthAlgorithm::setRunParameters(const QMap<QString, QList<QPair<QStrin
 
 AlgorithmResult PwpLengthAlgorithm::run(const AlgorithmContext& context)
 {
-    return test(context.input);
+    return test(context.input, RoiAlignment::fromVariant(context.getData(RoiAlignment::contextKey(), QVariant())));
 }
 
 // 辅助：将 Halcon Region 转为 ResultPath (调试用)
 void addRegionToResult(AlgorithmResult& result, const HObject& region, const QColor& color, int limit = 50) {
-    if (!region.IsInitialized()) return;
-
-    HTuple count;
-    CountObj(region, &count);
-    if (count.I() == 0) return;
-
-    int drawLimit = (count.I() > limit) ? limit : count.I();
-
-    for (int i = 1; i <= drawLimit; ++i) {
-        HObject single;
-        SelectObj(region, &single, i);
-        HTuple rows, cols;
-        try {
-            // 使用 GetRegionPolygon 获取多边形边界
-            GetRegionPolygon(single, 5.0, &rows, &cols);
-        }
-        catch (...) { continue; }
-
-        if (rows.Length() > 0) {
-            QPainterPath path;
-            path.moveTo(cols[0].D(), rows[0].D());
-            for (int k = 1; k < rows.Length(); ++k) {
-                path.lineTo(cols[k].D(), rows[k].D());
-            }
-            path.closeSubpath();
-            auto pathShape = std::make_shared<ResultPath>(path, color);
-            result.addResultShape(pathShape);
-        }
+    // 所有区域的多边形边界(GetRegionPolygon)合并为一个路径图形
+    ResultPolylineBatch polygons;
+    polygons.addRegions(region, 5.0, limit);
+    if (auto shape = polygons.toShape(color)) {
+        result.addResultShape(shape);
     }
 }
 
-AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
+AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input, const RoiAlignment& alignment)
 {
     AlgorithmResult result;
 
@@ -171,6 +167,10 @@ AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
         int minArea = prop_obj_->propValue("min_area").toInt();
         double minSkelLen = prop_obj_->propValue("min_skel_len").toDouble();
         double maxGap = prop_obj_->propValue("max_gap").toDouble();
+        // 原生区域后端：阈值及后续区域运算在游程区域上多线程完成，结果转换回Halcon区域做骨架提取
+        const bool nativeRegion = prop_obj_->propValue("region_backend").toString() == "原生";
+        // 原生骨架测长：每个骨架连通域取最长测地路径，分叉不计入；之后按Halcon流程的长度筛选和两级间隙连接合并
+        const bool nativeSkeleton = prop_obj_->propValue("skeleton_backend").toString() == "原生";
 
         // 3. ROI 解析 (XLD 填充模式)
         HObject ho_ROI_Search;
@@ -235,6 +235,8 @@ AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
             GetDomain(hImg, &ho_ROI_Search);
         }
         else {
+            // ROI绘制在模板图像上，按上游匹配位姿变换到当前图像
+            ho_ROI_Search = alignment.mapRegion(ho_ROI_Search);
             // 调试：绘制蓝色ROI
             addRegionToResult(result, ho_ROI_Search, Qt::blue);
         }
@@ -256,7 +258,18 @@ AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
         GaussFilter(ho_ImageReduced, &ho_ImageGauss, 3.0);
         ScaleImageMax(ho_ImageGauss, &ho_ImageScaled);
 
-        Threshold(ho_ImageScaled, &ho_RegionDark, thMin, thMax);
+        HTuple hv_Width, hv_Height;
+        RleRegion rleDark, rleFinal;
+        if (nativeRegion) {
+            HTuple pointer, type;
+            GetImagePointer1(ho_ImageScaled, &pointer, &type, &hv_Width, &hv_Height);
+            rleDark = RleOps::threshold(reinterpret_cast<const uint8_t*>(pointer.L()), hv_Width.I(), hv_Height.I(),
+                hv_Width.I(), RleRegion::fromHObject(ho_ROI_Search), thMin, thMax);
+            ho_RegionDark = rleDark.toHObject();
+        }
+        else {
+            Threshold(ho_ImageScaled, &ho_RegionDark, thMin, thMax);
+        }
 
         // 调试：绘制二值化结果（红色）
         addRegionToResult(result, ho_RegionDark, Qt::red);
@@ -270,31 +283,121 @@ AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
             return result;
         }
 
-        Connection(ho_RegionDark, &ho_ConnectedRegions);
+        if (nativeRegion) {
+            // 连通域标记同时得到面积；不做开运算时面积筛选直接查表
+            const RleComponents components = RleComponents::label(rleDark);
+            std::vector<RleRegion> bigRegions;
+            if (openRadius > 0.001) {
+                std::vector<RleRegion> regions;
+                regions.reserve(components.size());
+                for (size_t i = 0; i < components.size(); ++i) {
+                    regions.push_back(components.region(i));
+                }
+                bigRegions = RleOps::selectArea(RleOps::openingCircle(regions, openRadius), minArea, 99999999);
+            }
+            else {
+                for (size_t i : components.selectArea(minArea, 99999999)) {
+                    bigRegions.push_back(components.region(i));
+                }
+            }
+
+            // 检查点 2
+            if (bigRegions.empty()) {
+                result.setMsg(QString("NG: 筛选后为空 (最大面积 < %1)").arg(minArea));
+                result.setResultType(ResultType::OK);
+                return result;
+            }
 
-        if (openRadius > 0.001) {
-            OpeningCircle(ho_ConnectedRegions, &ho_RegionClean, openRadius);
+            RleRegion merged = RleOps::closingCircle(RleOps::union1(bigRegions), 10.5);
+            merged = RleOps::openingCircle(RleOps::fillUp(merged), 5.5);
+            rleFinal = RleOps::clip(RleOps::erosionCircle(merged, 1.5), hv_Width.I(), hv_Height.I());
+            ho_RegionFinal = rleFinal.toHObject();
         }
         else {
-            ho_RegionClean = ho_ConnectedRegions;
+            Connection(ho_RegionDark, &ho_ConnectedRegions);
+
+            if (openRadius > 0.001) {
+                OpeningCircle(ho_ConnectedRegions, &ho_RegionClean, openRadius);
+            }
+            else {
+                ho_RegionClean = ho_ConnectedRegions;
+            }
+
+            SelectShape(ho_RegionClean, &ho_BigRegions, "area", "and", minArea, 99999999);
+
+            // 检查点 2
+            CountObj(ho_BigRegions, &areaDebug);
+            if (areaDebug.I() == 0) {
+                result.setMsg(QString("NG: 筛选后为空 (最大面积 < %1)").arg(minArea));
+                result.setResultType(ResultType::OK);
+                return result;
+            }
+
+            Union1(ho_BigRegions, &ho_RegionUnion);
+            ClosingCircle(ho_RegionUnion, &ho_RegionClosed, 10.5);
+            FillUp(ho_RegionClosed, &ho_RegionFilled);
+            OpeningCircle(ho_RegionFilled, &ho_RegionSmooth, 5.5);
+            ErosionCircle(ho_RegionSmooth, &ho_RegionFinal, 1.5);
         }
 
-        SelectShape(ho_RegionClean, &ho_BigRegions, "area", "and", minArea, 99999999);
+        if (nativeSkeleton) {
+            std::vector<SkeletonPath::Measurement> paths =
+                SkeletonPath::measure(nativeRegion ? rleFinal : RleRegion::fromHObject(ho_RegionFinal), 31);
+            // 与Halcon流程一致：去掉短于min_skel_len的路径 -> max_gap内共线连接（夹角上限0.7同UnionCollinearContoursXld）
+            // -> 去掉短于secondaryLen的路径 -> 500像素内不限方向连接（同UnionAdjacentContoursXld(500, 1)） -> finalLen筛选
+            paths.erase(std::remove_if(paths.begin(), paths.end(), [minSkelLen](const SkeletonPath::Measurement& m) {
+                return m.length < minSkelLen;
+            }), paths.end());
+            if (paths.empty()) {
+                result.setMsg("NG: 骨架提取后为空");
+                result.setResultType(ResultType::OK);
+                return result;
+            }
+            paths = SkeletonPath::bridge(std::move(paths), maxGap, 0.7);
+
+            const double secondaryLen = (minSkelLen * 2.0 > 100.0) ? 100.0 : (minSkelLen * 2.0);
+            paths.erase(std::remove_if(paths.begin(), paths.end(), [secondaryLen](const SkeletonPath::Measurement& m) {
+                return m.length < secondaryLen;
+            }), paths.end());
+            paths = SkeletonPath::bridge(std::move(paths), 500.0, 3.14159265358979323846, 1.0);
+
+            const double finalLen = (minSkelLen * 3.0 > 300.0) ? 300.0 : (minSkelLen * 3.0);
+            double totalLen = 0.0;
+            ResultPolylineBatch lines(0.5);
+            std::vector<float> xy;
+            for (const auto& m : paths) {
+                if (m.length < finalLen) {
+                    break;
+                }
+                totalLen += m.length;
+                xy.clear();
+                for (const auto& pt : m.path) {
+                    xy.push_back(static_cast<float>(pt.col));
+                    xy.push_back(static_cast<float>(pt.row));
+                }
+                lines.addPolyline(xy.data(), xy.size() / 2);
+            }
 
-        // 检查点 2
-        CountObj(ho_BigRegions, &areaDebug);
-        if (areaDebug.I() == 0) {
-            result.setMsg(QString("NG: 筛选后为空 (最大面积 < %1)").arg(minArea));
+            if (totalLen > 0) {
+                if (auto shape = lines.toShape(Qt::green)) {
+                    result.addResultShape(shape);
+                }
+                auto text = std::make_shared<ResultText>();
+                text->text_ = QString("Total Length: %1 px").arg(totalLen, 0, 'f', 2);
+                text->text_pos_ = QPointF(20, 50);
+                text->font_size_ = 40;
+                text->setColor(Qt::white);
+                result.addResultShape(text);
+
+                result.setMsg(QString("检测成功: %1 px").arg(totalLen));
+            }
+            else {
+                result.setMsg("NG: 最终骨架为空");
+            }
             result.setResultType(ResultType::OK);
             return result;
         }
 
-        Union1(ho_BigRegions, &ho_RegionUnion);
-        ClosingCircle(ho_RegionUnion, &ho_RegionClosed, 10.5);
-        FillUp(ho_RegionClosed, &ho_RegionFilled);
-        OpeningCircle(ho_RegionFilled, &ho_RegionSmooth, 5.5);
-        ErosionCircle(ho_RegionSmooth, &ho_RegionFinal, 1.5);
-
         Skeleton(ho_RegionFinal, &ho_SkeletonRegion);
         GenContoursSkeletonXld(ho_SkeletonRegion, &ho_SkeletonContours, 1, "filter");
         SegmentContoursXld(ho_SkeletonContours, &ho_ContoursSplit, "lines_circles", 5, 4, 2);
@@ -331,24 +434,11 @@ AlgorithmResult PwpLengthAlgorithm::test(const AlgorithmInput& input)
         }
 
         if (totalLen > 0) {
-            // 画出所有检测到的绿色曲线
-            HTuple count;
-            CountObj(ho_SmoothedLine, &count);
-            for (int i = 1; i <= count.I(); ++i) {
-                HObject singleObj;
-                SelectObj(ho_SmoothedLine, &singleObj, i);
-                HTuple rows, cols;
-                GetContourXld(singleObj, &rows, &cols);
-
-                if (rows.Length() > 0) {
-                    QPainterPath path;
-                    path.moveTo(cols[0].D(), rows[0].D());
-                    for (int k = 1; k < rows.Length(); ++k) {
-                        path.lineTo(cols[k].D(), rows[k].D());
-                    }
-                    auto pathShape = std::make_shared<ResultPath>(path, Qt::green);
-                    result.addResultShape(pathShape);
-                }
+            // 画出所有检测到的绿色曲线（平滑后的轮廓点很密，抽稀到半像素）
+            ResultPolylineBatch lines(0.5);
+            lines.addContours(ho_SmoothedLine);
+            if (auto shape = lines.toShape(Qt::green)) {
+                result.addResultShape(shape);
             }
 
             // 【核心修改】：在图像左上角显示总长度
@@ -3,6 +3,7 @@
 
 #include "ialgorithm.h"
 #include "configurable_object.h"
+#include "roi_alignment.h"
 #include <QVector>
 #include <memory>
 
@@ -29,7 +30,8 @@ public:
 
     // 运行接口
     virtual AlgorithmResult run(const AlgorithmContext& input) override;
-    AlgorithmResult test(const AlgorithmInput& input);
+    // alignment：ROI位姿对齐（run()中由上游匹配步骤写入上下文的位姿给出），默认不对齐
+    AlgorithmResult test(const AlgorithmInput& input, const RoiAlignment& alignment = RoiAlignment());
 
 private:
     void setupProperties();
@@ -1,6 +1,7 @@
 ﻿#include "read_code_algorithm.h"
 #include "roi_shape.h"
 #include "result_shape.h"
+#include "result_batch.h"
 
 ReadCodeAlgorithm::ReadCodeAlgorithm(): 
     prop_obj_(new ConfigurableObject()),
@@ -84,7 +85,7 @@ HTuple ReadCodeAlgorithm::corAngle(double angle)
         return HTuple(360 - angle);
 }
 
-HObject ReadCodeAlgorithm::getRoiMaskImage(HObject& image, const QVector<std::shared_ptr<RoiShape>> shapes)
+HObject ReadCodeAlgorithm::getRoiMaskImage(HObject& image, const QVector<std::shared_ptr<RoiShape>> shapes, const RoiAlignment& alignment)
 {
     HObject empRegion, empRegionMask;
     GenEmptyRegion(&empRegion);
@@ -182,6 +183,8 @@ HObject ReadCodeAlgorithm::getRoiMaskImage(HObject& image, const QVector<std::sh
     HalconCpp::Union1(empRegion, &empRegionUnion);
     HalconCpp::Union1(empRegionMask, &empRegionMaskUnion);
     Difference(empRegionUnion, empRegionMaskUnion, &finalRegion);
+    // 在裁剪到图像范围之前变换，避免模板图像边界外的ROI部分丢失
+    finalRegion = alignment.mapRegion(finalRegion);
     Intersection(image, finalRegion, &finalRegion);
     return finalRegion;
 }
@@ -355,10 +358,10 @@ AlgorithmResult ReadCodeAlgorithm::test(const AlgorithmInput& input)
         //! 四个角点坐标
         GetContourXld(ho_SymbolXLDs, &hv_Row, &hv_Col);
         QVector<QPointF> contour;
-        for (int i = 0; i < hv_Row.Length() - 1; ++i) {
-            // contour.push_back(QPointF(hv_Col[i].D(), hv_Row[i].D()));
-            auto rect = std::make_shared<ResultRect>(QPointF(hv_Col[i].D(), hv_Row[i].D()), 4, 4, Qt::red);
-            result.addResultShape(rect);
+        ResultPointBatch corners;
+        corners.add(hv_Row, hv_Col, hv_Row.Length() - 1);
+        if (auto shape = corners.toShape(Qt::red)) {
+            result.addResultShape(shape);
         }
     }
 
@@ -392,7 +395,9 @@ AlgorithmResult ReadCodeAlgorithm::run(const AlgorithmContext& context)
         return result;
     }
 
-    HObject ROI = getRoiMaskImage(hSrc, roishapes_);
+    // ROI绘制在模板图像上，按上游匹配步骤写入上下文的位姿变换到当前图像
+    RoiAlignment alignment = RoiAlignment::fromVariant(context.getData(RoiAlignment::contextKey(), QVariant()));
+    HObject ROI = getRoiMaskImage(hSrc, roishapes_, alignment);
     ReduceDomain(hSrc, ROI, &imageReduced);
     int index = 0;
     bool readSuccess = true;
@@ -534,10 +539,10 @@ AlgorithmResult ReadCodeAlgorithm::run(const AlgorithmContext& context)
         //! 四个角点坐标
         GetContourXld(ho_SymbolXLDs, &hv_Row, &hv_Col);
         QVector<QPointF> contour;
-        for (int i = 0; i < hv_Row.Length() - 1; ++i) {
-            // contour.push_back(QPointF(hv_Col[i].D(), hv_Row[i].D()));
-            auto rect = std::make_shared<ResultRect>(QPointF(hv_Col[i].D(), hv_Row[i].D()), 4, 4, Qt::red);
-            result.addResultShape(rect);
+        ResultPointBatch corners;
+        corners.add(hv_Row, hv_Col, hv_Row.Length() - 1);
+        if (auto shape = corners.toShape(Qt::red)) {
+            result.addResultShape(shape);
         }
 
         QString resultText = "识别结果：" + codeResult;
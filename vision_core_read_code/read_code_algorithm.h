@@ -8,6 +8,7 @@
 #include "configurable_object.h"
 #include "property_editor_widget.h"
 #include "roi_shape.h"
+#include "roi_alignment.h"
 
 using namespace HalconCpp;
 class ReadCodeAlgorithm: public IAlgorithm
@@ -23,7 +24,9 @@ public:
     virtual AlgorithmResult run(const AlgorithmContext& input) override;
     AlgorithmResult test(const AlgorithmInput& input);
 private:
-    HObject getRoiMaskImage(HObject& image, const QVector<std::shared_ptr<RoiShape>> shapes);
+    // ROI绘制在模板图像上，先按位姿变换ROI区域，再与当前图像求交得到掩膜
+    HObject getRoiMaskImage(HObject& image, const QVector<std::shared_ptr<RoiShape>> shapes,
+        const RoiAlignment& alignment = RoiAlignment());
     HTuple corAngle(double angle);
     void setupProperties();
 private: